@@ -7,6 +7,7 @@
 #ifndef _CAMELLIA_SIMD_H_
 #define _CAMELLIA_SIMD_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define CAMELLIA_TABLE_BYTE_LEN 272
@@ -32,6 +33,105 @@ void camellia_encrypt_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
 void camellia_decrypt_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
 				  const void *in);
 
+/* SIMD128 vector implementation of Camellia for partial batches. Same as
+ * camellia_encrypt_16blks_simd128/camellia_decrypt_16blks_simd128 but for
+ * NBLKS blocks, 1 to 16. Blocks past NBLKS are not read from IN or written
+ * to OUT. */
+void camellia_encrypt_nblks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in, unsigned int nblks);
+void camellia_decrypt_nblks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in, unsigned int nblks);
+
+/* SIMD128 vector implementation of Camellia for 1, 2 and 4 blocks. These
+ * use the 1-way F-function of key-setup (AES SubBytes or GFNI for s-boxes)
+ * with rounds of blocks interleaved. Single block latency is higher than
+ * with table based implementations; these are provided as constant time
+ * alternative, without secret dependent table lookups, for serial modes such
+ * as CBC encryption and CMAC. Modes in this library do not use them. OUT and
+ * IN may be unaligned and may point to same buffer. */
+void camellia_encrypt_1blk_simd128(struct camellia_simd_ctx *ctx, void *out,
+				   const void *in);
+void camellia_decrypt_1blk_simd128(struct camellia_simd_ctx *ctx, void *out,
+				   const void *in);
+void camellia_encrypt_2blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in);
+void camellia_decrypt_2blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in);
+void camellia_encrypt_4blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in);
+void camellia_decrypt_4blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in);
+
+/* SIMD128 vector implementation of Camellia in CTR mode. Encrypts 16
+ * big-endian counter blocks starting from IV and XORs result with 16 blocks
+ * from IN and writes result to OUT. IV is 16 byte big-endian counter and is
+ * incremented by 16. OUT and IN may be unaligned and may point to same
+ * buffer. */
+void camellia_ctr_enc_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *iv);
+
+/* SIMD128 vector implementation of Camellia in CBC mode. Decrypts 16
+ * ciphertext blocks from IN, XORs each result with previous ciphertext block
+ * (IV for first block) and writes result to OUT. IV is replaced with last
+ * ciphertext block. OUT and IN may be unaligned and may point to same
+ * buffer. */
+void camellia_cbc_dec_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *iv);
+
+/* SIMD128 vector implementation of Camellia in CFB mode. Encrypts IV and 15
+ * first ciphertext blocks from IN, XORs result with 16 ciphertext blocks
+ * from IN and writes result to OUT. IV is replaced with last ciphertext
+ * block. OUT and IN may be unaligned and may point to same buffer. */
+void camellia_cfb_dec_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *iv);
+
+/* SIMD128 vector implementation of Camellia in XTS mode. Encrypts/decrypts
+ * 16 blocks from IN and writes result to OUT. TWEAK is encrypted tweak of
+ * first block and is updated to tweak of next block. OUT and IN may be
+ * unaligned and may point to same buffer. */
+void camellia_xts_enc_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *tweak);
+void camellia_xts_dec_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *tweak);
+
+/* SIMD128 vector implementation of Camellia in OCB mode. Encrypts/decrypts
+ * 16 blocks from IN and writes result to OUT. OFFSET is offset of previous
+ * block and LS points to 16 offset deltas (16 bytes each), offset of block i
+ * being OFFSET XOR LS[i]. OFFSET is updated to offset of last block and
+ * plaintext blocks are XORed to CHECKSUM. OUT and IN may be unaligned and
+ * may point to same buffer. */
+void camellia_ocb_enc_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *offset,
+				     void *checksum, const void *Ls);
+void camellia_ocb_dec_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *offset,
+				     void *checksum, const void *Ls);
+
+/* SIMD128 vector implementation of GHASH. Updates GHASH state HASH with
+ * NBLKS 16 byte blocks from IN. HTABLE points to byte-reversed powers of
+ * hash key H^16, ..., H^1 (16 bytes each), as in struct camellia_gcm_ctx.
+ * IN may be unaligned. */
+void camellia_ghash_simd128(void *hash, const void *Htable, const void *in,
+			    size_t nblks);
+
+/* SIMD128 vector implementation of POLYVAL (RFC 8452). Updates POLYVAL state
+ * HASH with NBLKS 16 byte blocks from IN. POLYVAL is computed as GHASH
+ * without byte-reversal of state and input, so HTABLE is same as for
+ * camellia_ghash_simd128 with hash key H = mulX_GHASH(ByteReverse(K)) for
+ * POLYVAL key K. IN may be unaligned. */
+void camellia_polyval_simd128(void *hash, const void *Htable, const void *in,
+			      size_t nblks);
+
+/* SIMD128 vector implementation of Camellia in GCM mode. Encrypts 16 blocks
+ * in CTR mode as camellia_ctr_enc_16blks_simd128 and updates GHASH state
+ * HASH with 16 blocks from GHASH_IN as camellia_ghash_simd128. GHASH_IN is
+ * read before OUT is written, so GHASH_IN may be IN (decryption) or
+ * previously written output (encryption). OUT, IN and GHASH_IN may be
+ * unaligned and OUT and IN may point to same buffer. */
+void camellia_gcm_16blks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				 const void *in, void *iv, void *hash,
+				 const void *Htable, const void *ghash_in);
+
 /* SIMD256 vector implementation of Camellia. These are 256-bit vector
  * variants (on x86, AES-NI / AVX2). IN is pointer to 32 plaintext
  * blocks and OUT is pointer to 32 ciphertext blocks. OUT and IN may be
@@ -41,4 +141,453 @@ void camellia_encrypt_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
 void camellia_decrypt_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
 				     const void *in);
 
+/* SIMD256 vector implementation of Camellia for partial batches. Same as
+ * camellia_encrypt_nblks_simd128/camellia_decrypt_nblks_simd128 but for
+ * NBLKS blocks, 1 to 32. */
+void camellia_encrypt_nblks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in, unsigned int nblks);
+void camellia_decrypt_nblks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in, unsigned int nblks);
+
+/* SIMD256 vector implementation of Camellia in CTR mode. Same as
+ * camellia_ctr_enc_16blks_simd128 but for 32 blocks. IV is incremented by
+ * 32. */
+void camellia_ctr_enc_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *iv);
+
+/* SIMD256 vector implementation of Camellia in CBC mode. Same as
+ * camellia_cbc_dec_16blks_simd128 but for 32 blocks. */
+void camellia_cbc_dec_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *iv);
+
+/* SIMD256 vector implementation of Camellia in CFB mode. Same as
+ * camellia_cfb_dec_16blks_simd128 but for 32 blocks. */
+void camellia_cfb_dec_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *iv);
+
+/* SIMD256 vector implementation of Camellia in XTS mode. Same as
+ * camellia_xts_enc_16blks_simd128/camellia_xts_dec_16blks_simd128 but for
+ * 32 blocks. */
+void camellia_xts_enc_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *tweak);
+void camellia_xts_dec_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *tweak);
+
+/* SIMD256 vector implementation of Camellia in OCB mode. Same as
+ * camellia_ocb_enc_16blks_simd128/camellia_ocb_dec_16blks_simd128 but for
+ * 32 blocks, LS points to 32 offset deltas. */
+void camellia_ocb_enc_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *offset,
+				     void *checksum, const void *Ls);
+void camellia_ocb_dec_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, void *offset,
+				     void *checksum, const void *Ls);
+
+/* SIMD256 vector implementation of GHASH, POLYVAL and Camellia in GCM mode.
+ * Same as camellia_ghash_simd128, camellia_polyval_simd128 and
+ * camellia_gcm_16blks_simd128 but GCM mode function is for 32 blocks. */
+void camellia_ghash_simd256(void *hash, const void *Htable, const void *in,
+			    size_t nblks);
+void camellia_polyval_simd256(void *hash, const void *Htable, const void *in,
+			      size_t nblks);
+void camellia_gcm_32blks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				 const void *in, void *iv, void *hash,
+				 const void *Htable, const void *ghash_in);
+
+/* SIMD512 vector implementation of Camellia. These are 512-bit vector
+ * variants (on x86, AVX512 with VAES or GFNI). IN is pointer to 64
+ * plaintext blocks and OUT is pointer to 64 ciphertext blocks. OUT and IN
+ * may be unaligned. */
+void camellia_encrypt_64blks_simd512(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in);
+void camellia_decrypt_64blks_simd512(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in);
+
+/* Register-resident 32-block variant of SIMD256 implementation for x86-64
+ * with EVEX encoded 256-bit vectors (AVX512VL or AVX10/256) and GFNI.
+ * IN is pointer to 32 plaintext blocks and OUT is pointer to 32 ciphertext
+ * blocks. OUT and IN may be unaligned. */
+void camellia_encrypt_32blks_simd256_evex(struct camellia_simd_ctx *ctx,
+					  void *out, const void *in);
+void camellia_decrypt_32blks_simd256_evex(struct camellia_simd_ctx *ctx,
+					  void *out, const void *in);
+
+/* Modes of operation for arbitrary length input, built on top of the
+ * SIMD128 and SIMD256 parallel implementations. Except for ECB, SIMD256
+ * variants use SIMD128 implementation for input lengths not multiple of 32
+ * blocks. */
+
+/* ECB mode encryption/decryption of NBLOCKS 16 byte blocks from IN to OUT.
+ * Full batches go through the parallel implementation of the variant's
+ * width and the remainder through one partial batch of the same width:
+ * final 1 to 15 blocks with camellia_{en,de}crypt_nblks_simd128 for SIMD128
+ * variants and final 1 to 31 blocks with camellia_{en,de}crypt_nblks_simd256
+ * for SIMD256 variants. Partial batches do not access OUT or IN past NBLOCKS
+ * blocks. OUT and IN may be unaligned and may point to same buffer. */
+void camellia_encrypt_blocks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks);
+void camellia_decrypt_blocks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks);
+void camellia_encrypt_blocks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks);
+void camellia_decrypt_blocks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks);
+
+/* SIMD512 variant of ECB mode encryption/decryption. Full batches of 64
+ * blocks go through SIMD512 implementation and remainder cascades through
+ * at most one 32 block SIMD256 batch, at most one 16 block SIMD128 batch and
+ * final 1 to 15 blocks with camellia_{en,de}crypt_nblks_simd128. */
+void camellia_encrypt_blocks_simd512(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks);
+void camellia_decrypt_blocks_simd512(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks);
+
+/* CTR mode encryption/decryption of NBYTES from IN to OUT. IV is 16 byte
+ * big-endian counter and is updated to the next unused counter value; a
+ * partial final block consumes one counter value. OUT and IN may be
+ * unaligned and may point to same buffer. */
+void camellia_ctr_encrypt_simd128(struct camellia_simd_ctx *ctx, void *out,
+				  const void *in, size_t nbytes, void *iv);
+void camellia_ctr_encrypt_simd256(struct camellia_simd_ctx *ctx, void *out,
+				  const void *in, size_t nbytes, void *iv);
+
+/* CBC mode decryption of NBYTES from IN to OUT. NBYTES must be multiple of
+ * 16. IV is replaced with last ciphertext block. OUT and IN may be unaligned
+ * and may point to same buffer. Returns 0 on success and -1, without
+ * touching OUT or IV, if NBYTES is not multiple of 16. */
+int camellia_cbc_decrypt_simd128(struct camellia_simd_ctx *ctx, void *out,
+				 const void *in, size_t nbytes, void *iv);
+int camellia_cbc_decrypt_simd256(struct camellia_simd_ctx *ctx, void *out,
+				 const void *in, size_t nbytes, void *iv);
+
+/* CFB mode (CFB-128) decryption of NBYTES from IN to OUT. IV is replaced
+ * with last full ciphertext block; a partial final block ends the stream.
+ * OUT and IN may be unaligned and may point to same buffer. */
+void camellia_cfb_decrypt_simd128(struct camellia_simd_ctx *ctx, void *out,
+				  const void *in, size_t nbytes, void *iv);
+void camellia_cfb_decrypt_simd256(struct camellia_simd_ctx *ctx, void *out,
+				  const void *in, size_t nbytes, void *iv);
+
+/* XTS mode encryption/decryption of NBYTES from IN to OUT. NBYTES must be at
+ * least 16; if NBYTES is not multiple of 16, ciphertext stealing is used for
+ * the final partial block and the data unit ends there. TWEAK is the
+ * encrypted tweak (tweak value encrypted with the second XTS key) and is
+ * updated to tweak of next block when NBYTES is multiple of 16. OUT and IN
+ * may be unaligned and may point to same buffer. */
+void camellia_xts_encrypt_simd128(struct camellia_simd_ctx *ctx, void *out,
+				  const void *in, size_t nbytes, void *tweak);
+void camellia_xts_decrypt_simd128(struct camellia_simd_ctx *ctx, void *out,
+				  const void *in, size_t nbytes, void *tweak);
+void camellia_xts_encrypt_simd256(struct camellia_simd_ctx *ctx, void *out,
+				  const void *in, size_t nbytes, void *tweak);
+void camellia_xts_decrypt_simd256(struct camellia_simd_ctx *ctx, void *out,
+				  const void *in, size_t nbytes, void *tweak);
+
+/* OCB mode (RFC 7253) context, cipher context extended with precomputed
+ * L-table: L_STAR = ENCIPHER(K, zeros), L_DOLLAR = double(L_STAR),
+ * L[0] = double(L_DOLLAR) and L[i] = double(L[i - 1]). */
+struct camellia_ocb_ctx
+{
+  struct camellia_simd_ctx cipher;
+  uint8_t L_star[16];
+  uint8_t L_dollar[16];
+  uint8_t L[64][16];
+};
+
+/* Key-setup for OCB mode, sets up cipher context and L-table. Supported key
+ * lengths are same as for camellia_keysetup_simd128. */
+int camellia_ocb_keysetup_simd128(struct camellia_ocb_ctx *ctx,
+				  const void *key, unsigned int keylen);
+
+/* OCB mode (RFC 7253) authenticated encryption of NBYTES from IN to OUT with
+ * 128-bit tag. NONCE is NONCELEN bytes, 1 to 15. AD is ADLEN bytes of
+ * associated data. TAG (16 bytes) is written by encryption and checked by
+ * decryption, which returns 0 if tag matches and -1 otherwise; OUT must be
+ * discarded if tag does not match. OUT and IN may be unaligned and may point
+ * to same buffer. */
+void camellia_ocb_encrypt_simd128(struct camellia_ocb_ctx *ctx, void *out,
+				  const void *in, size_t nbytes,
+				  const void *nonce, size_t noncelen,
+				  const void *ad, size_t adlen, void *tag);
+int camellia_ocb_decrypt_simd128(struct camellia_ocb_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *nonce, size_t noncelen,
+				 const void *ad, size_t adlen, const void *tag);
+void camellia_ocb_encrypt_simd256(struct camellia_ocb_ctx *ctx, void *out,
+				  const void *in, size_t nbytes,
+				  const void *nonce, size_t noncelen,
+				  const void *ad, size_t adlen, void *tag);
+int camellia_ocb_decrypt_simd256(struct camellia_ocb_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *nonce, size_t noncelen,
+				 const void *ad, size_t adlen, const void *tag);
+
+/* GCM mode context, cipher context extended with byte-reversed powers of
+ * hash key H = ENCIPHER(K, zeros) for aggregated GHASH: HTABLE[i] is H^(16-i)
+ * with bytes in reversed order. */
+struct camellia_gcm_ctx
+{
+  struct camellia_simd_ctx cipher;
+  uint8_t Htable[16][16];
+};
+
+/* Key-setup for GCM mode, sets up cipher context and hash key powers.
+ * Supported key lengths are same as for camellia_keysetup_simd128. */
+int camellia_gcm_keysetup_simd128(struct camellia_gcm_ctx *ctx,
+				  const void *key, unsigned int keylen);
+
+/* GCM mode authenticated encryption of NBYTES from IN to OUT with 128-bit
+ * tag. IV is IVLEN bytes, IVLEN must be non-zero and 12 is recommended. AD
+ * is ADLEN bytes of associated data. TAG (16 bytes) is written by
+ * encryption and checked by decryption, which returns 0 if tag matches and
+ * -1 otherwise; OUT must be discarded if tag does not match. SIMD128
+ * variants use camellia_ghash_simd128 and SIMD256 variants use
+ * camellia_ghash_simd256. OUT and IN may be unaligned and may point to same
+ * buffer. */
+void camellia_gcm_encrypt_simd128(struct camellia_gcm_ctx *ctx, void *out,
+				  const void *in, size_t nbytes,
+				  const void *iv, size_t ivlen,
+				  const void *ad, size_t adlen, void *tag);
+int camellia_gcm_decrypt_simd128(struct camellia_gcm_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *iv, size_t ivlen,
+				 const void *ad, size_t adlen, const void *tag);
+void camellia_gcm_encrypt_simd256(struct camellia_gcm_ctx *ctx, void *out,
+				  const void *in, size_t nbytes,
+				  const void *iv, size_t ivlen,
+				  const void *ad, size_t adlen, void *tag);
+int camellia_gcm_decrypt_simd256(struct camellia_gcm_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *iv, size_t ivlen,
+				 const void *ad, size_t adlen, const void *tag);
+
+/* GCM-SIV mode (RFC 8452) context, key-generating key for per-nonce
+ * derivation of message authentication and encryption keys. */
+struct camellia_gcm_siv_ctx
+{
+  struct camellia_simd_ctx cipher;
+};
+
+/* Key-setup for GCM-SIV mode. Supported key lengths are 16 and 32 bytes. */
+int camellia_gcm_siv_keysetup_simd128(struct camellia_gcm_siv_ctx *ctx,
+				      const void *key, unsigned int keylen);
+
+/* GCM-SIV mode (RFC 8452, with Camellia in place of AES) nonce misuse
+ * resistant authenticated encryption of NBYTES from IN to OUT with 128-bit
+ * tag. NONCE is 12 bytes. AD is ADLEN bytes of associated data. Tag is
+ * computed with POLYVAL over AD and plaintext and is used as initial counter
+ * for CTR encryption. TAG (16 bytes) is written by encryption and checked by
+ * decryption, which returns 0 if tag matches and -1 otherwise; OUT must be
+ * discarded if tag does not match. SIMD128 variants use
+ * camellia_polyval_simd128 and SIMD256 variants use
+ * camellia_polyval_simd256. OUT and IN may be unaligned and may point to
+ * same buffer. */
+void camellia_gcm_siv_encrypt_simd128(struct camellia_gcm_siv_ctx *ctx,
+				      void *out, const void *in, size_t nbytes,
+				      const void *nonce, const void *ad,
+				      size_t adlen, void *tag);
+int camellia_gcm_siv_decrypt_simd128(struct camellia_gcm_siv_ctx *ctx,
+				     void *out, const void *in, size_t nbytes,
+				     const void *nonce, const void *ad,
+				     size_t adlen, const void *tag);
+void camellia_gcm_siv_encrypt_simd256(struct camellia_gcm_siv_ctx *ctx,
+				      void *out, const void *in, size_t nbytes,
+				      const void *nonce, const void *ad,
+				      size_t adlen, void *tag);
+int camellia_gcm_siv_decrypt_simd256(struct camellia_gcm_siv_ctx *ctx,
+				     void *out, const void *in, size_t nbytes,
+				     const void *nonce, const void *ad,
+				     size_t adlen, const void *tag);
+
+/* Independent CBC encryption stream for multi-stream CBC encryption. IN and
+ * OUT point to NBYTES of plaintext and ciphertext, NBYTES must be multiple
+ * of 16. IV is replaced with last ciphertext block when stream has been
+ * encrypted. OUT and IN may be unaligned and may point to same buffer. */
+struct camellia_cbc_stream
+{
+  void *out;
+  const void *in;
+  size_t nbytes;
+  uint8_t iv[16];
+};
+
+/* Multi-stream CBC mode encryption of NSTREAMS independent streams. CBC
+ * encryption is serial within stream, so each parallel block lane is
+ * assigned its own stream (16 lanes for SIMD128 and 32 lanes for SIMD256)
+ * and lanes are refilled with next streams as streams finish. */
+void camellia_cbc_encrypt_multi_simd128(struct camellia_simd_ctx *ctx,
+					struct camellia_cbc_stream *streams,
+					size_t nstreams);
+void camellia_cbc_encrypt_multi_simd256(struct camellia_simd_ctx *ctx,
+					struct camellia_cbc_stream *streams,
+					size_t nstreams);
+
+/* CCM mode (RFC 3610, RFC 5528) message for multi-message CCM. IN and OUT
+ * point to NBYTES of input and output. NONCE is NONCELEN bytes, 7 to 13,
+ * and sets length field size to 15 - NONCELEN bytes; NBYTES must fit to
+ * length field. AD is ADLEN bytes of associated data. TAG is TAGLEN bytes,
+ * TAGLEN must be even and from 4 to 16. TAG is written by encryption and
+ * checked by decryption, which sets STATUS to 0 if tag matches and -1
+ * otherwise; OUT must be discarded if tag does not match. OUT and IN may be
+ * unaligned and may point to same buffer. */
+struct camellia_ccm_msg
+{
+  void *out;
+  const void *in;
+  size_t nbytes;
+  const void *ad;
+  size_t adlen;
+  uint8_t nonce[13];
+  uint8_t noncelen;
+  uint8_t taglen;
+  uint8_t tag[16];
+  int status;
+};
+
+/* Multi-message CCM mode authenticated encryption and decryption of NMSGS
+ * independent messages. CBC-MAC is serial within message, so each parallel
+ * block lane is assigned its own message (16 lanes for SIMD128 and 32 lanes
+ * for SIMD256) and lanes are refilled with next messages as messages
+ * finish. CTR keystream blocks of messages are gathered to shared parallel
+ * batches. Decryption returns 0 if tags of all messages match and -1
+ * otherwise. */
+void camellia_ccm_encrypt_multi_simd128(struct camellia_simd_ctx *ctx,
+					struct camellia_ccm_msg *msgs,
+					size_t nmsgs);
+int camellia_ccm_decrypt_multi_simd128(struct camellia_simd_ctx *ctx,
+				       struct camellia_ccm_msg *msgs,
+				       size_t nmsgs);
+void camellia_ccm_encrypt_multi_simd256(struct camellia_simd_ctx *ctx,
+					struct camellia_ccm_msg *msgs,
+					size_t nmsgs);
+int camellia_ccm_decrypt_multi_simd256(struct camellia_simd_ctx *ctx,
+				       struct camellia_ccm_msg *msgs,
+				       size_t nmsgs);
+
+/* CMAC (NIST SP 800-38B, RFC 4493) context, cipher context extended with
+ * subkeys K1 and K2. */
+struct camellia_cmac_ctx
+{
+  struct camellia_simd_ctx cipher;
+  uint8_t K1[16];
+  uint8_t K2[16];
+};
+
+/* Key-setup for CMAC, sets up cipher context and subkeys. Supported key
+ * lengths are same as for camellia_keysetup_simd128. */
+int camellia_cmac_keysetup_simd128(struct camellia_cmac_ctx *ctx,
+				   const void *key, unsigned int keylen);
+
+/* Batched CMAC generation and verification of N independent messages with
+ * 128-bit tags. Message i is LENS[i] bytes at MSGS[i] and its tag is 16
+ * bytes at TAGS + i * 16. CMAC is serial within message, so each parallel
+ * block lane is assigned its own message (16 lanes for SIMD128 and 32 lanes
+ * for SIMD256) and lanes are refilled with next messages as messages
+ * finish. Verification compares tags in constant time, sets STATUS[i] (if
+ * STATUS is non-NULL) to 0 if tag of message i matches and -1 otherwise,
+ * and returns 0 if tags of all messages match and -1 otherwise. */
+void camellia_cmac_batch_simd128(struct camellia_cmac_ctx *ctx,
+				 const void *const *msgs, const size_t *lens,
+				 void *tags, size_t n);
+int camellia_cmac_verify_batch_simd128(struct camellia_cmac_ctx *ctx,
+				       const void *const *msgs,
+				       const size_t *lens, const void *tags,
+				       size_t n, int *status);
+void camellia_cmac_batch_simd256(struct camellia_cmac_ctx *ctx,
+				 const void *const *msgs, const size_t *lens,
+				 void *tags, size_t n);
+int camellia_cmac_verify_batch_simd256(struct camellia_cmac_ctx *ctx,
+				       const void *const *msgs,
+				       const size_t *lens, const void *tags,
+				       size_t n, int *status);
+
+/* SIV mode (RFC 5297 construction with Camellia in place of AES) context,
+ * CMAC context for S2V, cipher context for CTR and precomputed
+ * D0 = CMAC(zeros). */
+struct camellia_siv_ctx
+{
+  struct camellia_cmac_ctx mac;
+  struct camellia_simd_ctx ctr;
+  uint8_t D0[16];
+};
+
+/* Key-setup for SIV mode. KEYLEN is 32, 48 or 64 bytes, first half of KEY
+ * is used for S2V and second half for CTR encryption. */
+int camellia_siv_keysetup_simd128(struct camellia_siv_ctx *ctx,
+				  const void *key, unsigned int keylen);
+
+/* SIV mode message for multi-message SIV. IN and OUT point to NBYTES of
+ * input and output. Associated data consists of NAD components, component
+ * i is ADLENS[i] bytes at AD[i]; RFC 5297 allows at most 126 components
+ * (nonce, if used, is last component). IV is synthetic IV, written by
+ * encryption and checked by decryption, which sets STATUS to 0 if IV
+ * matches and -1 otherwise; OUT must be discarded if IV does not match.
+ * OUT and IN may be unaligned and may point to same buffer. */
+struct camellia_siv_msg
+{
+  void *out;
+  const void *in;
+  size_t nbytes;
+  const void *const *ad;
+  const size_t *adlens;
+  size_t nad;
+  uint8_t iv[16];
+  int status;
+};
+
+/* Multi-message SIV mode deterministic authenticated encryption and
+ * decryption of NMSGS independent messages. CMAC chains of S2V for
+ * associated data components and messages of several messages are
+ * processed in parallel block lanes (16 lanes for SIMD128 and 32 lanes for
+ * SIMD256) and CTR keystream blocks of messages are gathered to shared
+ * parallel batches. Decryption returns 0 if IVs of all messages match and
+ * -1 otherwise. */
+void camellia_siv_encrypt_multi_simd128(struct camellia_siv_ctx *ctx,
+					struct camellia_siv_msg *msgs,
+					size_t nmsgs);
+int camellia_siv_decrypt_multi_simd128(struct camellia_siv_ctx *ctx,
+				       struct camellia_siv_msg *msgs,
+				       size_t nmsgs);
+void camellia_siv_encrypt_multi_simd256(struct camellia_siv_ctx *ctx,
+					struct camellia_siv_msg *msgs,
+					size_t nmsgs);
+int camellia_siv_decrypt_multi_simd256(struct camellia_siv_ctx *ctx,
+				       struct camellia_siv_msg *msgs,
+				       size_t nmsgs);
+
+/* Key for batched key wrap (RFC 3394, RFC 3657) with default initial value
+ * A6A6A6A6A6A6A6A6. NBYTES is length of key data, multiple of 8 and at
+ * least 16. For wrapping, IN is NBYTES of key data and OUT receives
+ * NBYTES + 8 bytes of wrapped key. For unwrapping, IN is NBYTES + 8 bytes
+ * of wrapped key and OUT receives NBYTES of key data; STATUS is set to 0 if
+ * integrity check passes and -1 otherwise, in which case OUT is cleared.
+ * Key with invalid NBYTES is rejected with STATUS set to -1 and OUT left
+ * untouched. OUT and IN may be unaligned and may point to same buffer. */
+struct camellia_keywrap_key
+{
+  void *out;
+  const void *in;
+  size_t nbytes;
+  int status;
+};
+
+/* Batched key wrap and unwrap of NKEYS independent keys with key-encryption
+ * key context CTX. Key wrap is serial within key, so each parallel block
+ * lane is assigned its own key (16 lanes for SIMD128 and 32 lanes for
+ * SIMD256) and lanes are refilled with next keys as keys finish. Unwrap
+ * returns 0 if all keys are valid and pass integrity check and -1
+ * otherwise. */
+void camellia_keywrap_batch_simd128(struct camellia_simd_ctx *ctx,
+				    struct camellia_keywrap_key *keys,
+				    size_t nkeys);
+int camellia_keyunwrap_batch_simd128(struct camellia_simd_ctx *ctx,
+				     struct camellia_keywrap_key *keys,
+				     size_t nkeys);
+void camellia_keywrap_batch_simd256(struct camellia_simd_ctx *ctx,
+				    struct camellia_keywrap_key *keys,
+				    size_t nkeys);
+int camellia_keyunwrap_batch_simd256(struct camellia_simd_ctx *ctx,
+				     struct camellia_keywrap_key *keys,
+				     size_t nkeys);
+
 #endif /* _CAMELLIA_SIMD_H_ */
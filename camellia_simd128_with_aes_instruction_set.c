@@ -30,6 +30,7 @@ typedef vector signed char int8x16_t;
 typedef vector unsigned char uint8x16_t;
 typedef vector unsigned short uint16x8_t;
 typedef vector unsigned int uint32x4_t;
+typedef vector signed int int32x4_t;
 typedef vector unsigned long long uint64x2_t;
 typedef uint64x2_t __m128i;
 
@@ -48,6 +49,7 @@ typedef uint64x2_t __m128i;
 #define vpslld128(s, a, o)      ({ o = (__m128i)((uint32x4_t)a << s); })
 #define vpsrlq128(s, a, o)      ({ o = (__m128i)((uint64x2_t)a >> s); })
 #define vpsllq128(s, a, o)      ({ o = (__m128i)((uint64x2_t)a << s); })
+#define vpsrad128(s, a, o)      ({ o = (__m128i)((int32x4_t)a >> s); })
 #define vpsrldq128(s, a, o)     ({ uint64x2_t __tmp = { 0, 0 }; \
 				  o = (__m128i)vec_sld((uint8x16_t)__tmp, \
 						       (uint8x16_t)a, (16 - (s)) & 15);})
@@ -61,10 +63,17 @@ typedef uint64x2_t __m128i;
 #define vpsll_byte_128(s, a, o) vpsllb128(s, a, o)
 
 #define vpaddb128(a, b, o)      (o = (__m128i)vec_add((uint8x16_t)b, (uint8x16_t)a))
+#define vpaddq128(a, b, o)      (o = (__m128i)vec_add((uint64x2_t)b, (uint64x2_t)a))
 
 #define vpcmpgtb128(a, b, o)    (o = (__m128i)vec_cmpgt((int8x16_t)b, (int8x16_t)a))
 #define vpabsb128(a, o)         (o = (__m128i)vec_abs((int8x16_t)a))
 
+/* Carry-less multiply of single 64-bit lanes, vpmsumd with other lanes zeroed. */
+#define vpclmulqdq128(imm, a, b, o) \
+	({ uint64x2_t __tmpa = { (a)[((imm) >> 4) & 1], 0 }; \
+	   uint64x2_t __tmpb = { (b)[(imm) & 1], 0 }; \
+	   o = (__m128i)__builtin_crypto_vpmsumd(__tmpb, __tmpa); })
+
 #define vpshufd128_0x4e(a, o)   (o = (__m128i)vec_reve((uint64x2_t)a))
 #define vpshufd128_0x1b(a, o)   (o = (__m128i)vec_reve((uint32x4_t)a))
 
@@ -141,6 +150,7 @@ static const uint8x16_t shift_row =
 #define vpslld128(s, a, o)      (o = (__m128i)vshlq_n_u32((uint32x4_t)a, s))
 #define vpsrlq128(s, a, o)      (o = (__m128i)vshrq_n_u64(a, s))
 #define vpsllq128(s, a, o)      (o = (__m128i)vshlq_n_u64(a, s))
+#define vpsrad128(s, a, o)      (o = (__m128i)vshrq_n_s32((int32x4_t)a, s))
 #define vpsrldq128(s, a, o)     ({ uint64x2_t __tmp = { 0, 0 }; \
 				o = (__m128i)vextq_u8((uint8x16_t)a, \
 						      (uint8x16_t)__tmp, (s) & 15);})
@@ -154,10 +164,15 @@ static const uint8x16_t shift_row =
 #define vpsll_byte_128(s, a, o) vpsllb128(s, a, o)
 
 #define vpaddb128(a, b, o)      (o = (__m128i)vaddq_u8((uint8x16_t)b, (uint8x16_t)a))
+#define vpaddq128(a, b, o)      (o = vaddq_u64(b, a))
 
 #define vpcmpgtb128(a, b, o)    (o = (__m128i)vcgtq_s8((int8x16_t)b, (int8x16_t)a))
 #define vpabsb128(a, o)         (o = (__m128i)vabsq_s8((int8x16_t)a))
 
+#define vpclmulqdq128(imm, a, b, o) \
+	(o = vreinterpretq_u64_p128(vmull_p64(vgetq_lane_u64(b, (imm) & 1), \
+					      vgetq_lane_u64(a, ((imm) >> 4) & 1))))
+
 #define vpshufd128_0x4e(a, o)   (o = (__m128i)vextq_u8((uint8x16_t)a, (uint8x16_t)a, 8))
 #define vpshufd128_0x1b(a, o)   (o = (__m128i)vrev64q_u32((uint32x4_t)vextq_u8((uint8x16_t)a, (uint8x16_t)a, 8)))
 #define vpshufb128(m, a, o)     (o = (__m128i)vqtbl1q_u8((uint8x16_t)a, (uint8x16_t)m))
@@ -218,6 +233,7 @@ static const uint8x16_t shift_row =
 #define vpslld128(s, a, o)      (o = _mm_slli_epi32(a, s))
 #define vpsrlq128(s, a, o)      (o = _mm_srli_epi64(a, s))
 #define vpsllq128(s, a, o)      (o = _mm_slli_epi64(a, s))
+#define vpsrad128(s, a, o)      (o = _mm_srai_epi32(a, s))
 #define vpsrldq128(s, a, o)     (o = _mm_srli_si128(a, s))
 #define vpslldq128(s, a, o)     (o = _mm_slli_si128(a, s))
 
@@ -227,10 +243,13 @@ static const uint8x16_t shift_row =
 #define vpsll_byte_128(s, a, o) vpslld128(s, a, o)
 
 #define vpaddb128(a, b, o)      (o = _mm_add_epi8(b, a))
+#define vpaddq128(a, b, o)      (o = _mm_add_epi64(b, a))
 
 #define vpcmpgtb128(a, b, o)    (o = _mm_cmpgt_epi8(b, a))
 #define vpabsb128(a, o)         (o = _mm_abs_epi8(a))
 
+#define vpclmulqdq128(imm, a, b, o) (o = _mm_clmulepi64_si128(b, a, imm))
+
 #define vpshufd128_0x1b(a, o)   (o = _mm_shuffle_epi32(a, 0x1b))
 #define vpshufd128_0x4e(a, o)   (o = _mm_shuffle_epi32(a, 0x4e))
 #define vpshufb128(m, a, o)     (o = _mm_shuffle_epi8(a, m))
@@ -270,10 +289,38 @@ static const uint8x16_t shift_row =
 #define if_aes_subbytes(...) /*_*/
 #define if_not_aes_subbytes(...) __VA_ARGS__
 
+#ifdef USE_GFNI
+/* GFNI macros */
+#define vgf2p8affineqb128(b, A, x, o) \
+	(o = _mm_gf2p8affine_epi64_epi8(x, A, b))
+#define vgf2p8affineinvqb128(b, A, x, o) \
+	(o = _mm_gf2p8affineinv_epi64_epi8(x, A, b))
+#endif
+
 #define memory_barrier_with_vec(a) __asm__("" : "+x"(a) :: "memory")
 
+#ifdef __AVX512VL__
+/* Masked load/store of block I of N blocks with AVX512VL, blocks past N are
+ * not accessed. */
+#define blk_kmask128(i, n)      ((__mmask8)(-(unsigned int)((i) < (n)) & 3))
+#define vpxor128_memld_blk(rio, i, n, a, o) \
+	vpxor128(a, _mm_maskz_loadu_epi64(blk_kmask128(i, n), \
+					  (rio) + (i) * 16), o)
+#define vmovdqu128_memst_blk(a, rio, i, n) \
+	_mm_mask_storeu_epi64((rio) + (i) * 16, blk_kmask128(i, n), a)
+#endif
+
 #endif /* defined(__x86_64__) || defined(__i386__) */
 
+#ifndef vpxor128_memld_blk
+/* Load/store of block I of N blocks, blocks past N are not accessed. */
+#define vpxor128_memld_blk(rio, i, n, a, o) \
+	if ((i) < (n)) { vpxor128_memld((rio) + (i) * 16, a, o); } \
+	else { vmovdqa128(a, o); }
+#define vmovdqu128_memst_blk(a, rio, i, n) \
+	if ((i) < (n)) { vmovdqu128_memst(a, (rio) + (i) * 16); }
+#endif
+
 /**********************************************************************
   helper macros
  **********************************************************************/
@@ -308,6 +355,25 @@ static const uint8x16_t shift_row =
 	vmovdqa128_memld(&(constant), constant ## _stack); \
 	memory_barrier_with_vec(constant ## _stack)
 
+#ifdef USE_GFNI
+#define prepare_frequent_constants() \
+	prepare_frequent_const(pack_bswap); \
+	prepare_frequent_const(shufb_16x16b); \
+	prepare_frequent_const(pre_filter_bitmatrix_s123); \
+	prepare_frequent_const(pre_filter_bitmatrix_s4); \
+	prepare_frequent_const(post_filter_bitmatrix_s14); \
+	prepare_frequent_const(post_filter_bitmatrix_s2); \
+	prepare_frequent_const(post_filter_bitmatrix_s3)
+
+#define frequent_constants_declare \
+	__m128i pack_bswap_stack; \
+	__m128i shufb_16x16b_stack; \
+	__m128i pre_filter_bitmatrix_s123_stack; \
+	__m128i pre_filter_bitmatrix_s4_stack; \
+	__m128i post_filter_bitmatrix_s14_stack; \
+	__m128i post_filter_bitmatrix_s2_stack; \
+	__m128i post_filter_bitmatrix_s3_stack
+#else /* USE_GFNI */
 #define prepare_frequent_constants() \
 	prepare_frequent_const(inv_shift_row); \
 	prepare_frequent_const(pack_bswap); \
@@ -339,11 +405,136 @@ static const uint8x16_t shift_row =
 	__m128i post_tf_hi_s3_stack; \
 	__m128i post_tf_lo_s2_stack; \
 	__m128i post_tf_hi_s2_stack
+#endif /* USE_GFNI */
 
 /**********************************************************************
   16-way camellia macros
  **********************************************************************/
 
+/*
+ * P-function and key addition, end of round function.
+ *
+ * IN:
+ *   x0..x7: byte-sliced S-function output
+ *   t0: key material in low 64 bits
+ *   mem_cd: register pointer storing CD state
+ * OUT:
+ *   x0..x7: new byte-sliced CD state
+ */
+#define roundsm16_p_and_key(x0, x1, x2, x3, x4, x5, x6, x7, t0, t1, t2, t3, \
+			    t4, t5, t6, t7, mem_cd) \
+	/* P-function */ \
+	vpxor128(x5, x0, x0); \
+	vpxor128(x6, x1, x1); \
+	vpxor128(x7, x2, x2); \
+	vpxor128(x4, x3, x3); \
+	\
+	vpxor128(x2, x4, x4); \
+	vpxor128(x3, x5, x5); \
+	vpxor128(x0, x6, x6); \
+	vpxor128(x1, x7, x7); \
+	\
+	vpxor128(x7, x0, x0); \
+	vpxor128(x4, x1, x1); \
+	vpxor128(x5, x2, x2); \
+	vpxor128(x6, x3, x3); \
+	\
+	vpxor128(x3, x4, x4); \
+	vpxor128(x0, x5, x5); \
+	vpxor128(x1, x6, x6); \
+	vpxor128(x2, x7, x7); /* note: high and low parts swapped */ \
+	\
+	/* Add key material and result to CD (x becomes new CD) */ \
+	\
+	vpshufb128(bcast[7], t0, t7); \
+	vpshufb128(bcast[6], t0, t6); \
+	vpshufb128(bcast[5], t0, t5); \
+	vpshufb128(bcast[4], t0, t4); \
+	vpshufb128(bcast[3], t0, t3); \
+	vpshufb128(bcast[2], t0, t2); \
+	vpshufb128(bcast[1], t0, t1); \
+	\
+	vpxor128(t3, x4, x4); \
+	vpxor128(mem_cd[0], x4, x4); \
+	\
+	load_zero(t3); \
+	vpshufb128(t3, t0, t0); \
+	\
+	vpxor128(t2, x5, x5); \
+	vpxor128(mem_cd[1], x5, x5); \
+	\
+	vpxor128(t1, x6, x6); \
+	vpxor128(mem_cd[2], x6, x6); \
+	\
+	vpxor128(t0, x7, x7); \
+	vpxor128(mem_cd[3], x7, x7); \
+	\
+	vpxor128(t7, x0, x0); \
+	vpxor128(mem_cd[4], x0, x0); \
+	\
+	vpxor128(t6, x1, x1); \
+	vpxor128(mem_cd[5], x1, x1); \
+	\
+	vpxor128(t5, x2, x2); \
+	vpxor128(mem_cd[6], x2, x2); \
+	\
+	vpxor128(t4, x3, x3); \
+	vpxor128(mem_cd[7], x3, x3);
+
+#ifdef USE_GFNI
+
+/*
+ * GFNI version of round function.
+ *
+ * IN:
+ *   x0..x7: byte-sliced AB state
+ *   mem_cd: register pointer storing CD state
+ *   key: index for key material
+ * OUT:
+ *   x0..x7: new byte-sliced CD state
+ */
+#define roundsm16(x0, x1, x2, x3, x4, x5, x6, x7, t0, t1, t2, t3, t4, t5, t6, \
+		  t7, mem_cd, key) \
+	/* \
+	 * S-function with GFNI \
+	 */ \
+	load_frequent_const(pre_filter_bitmatrix_s123, t5); \
+	load_frequent_const(pre_filter_bitmatrix_s4, t2); \
+	load_frequent_const(post_filter_bitmatrix_s14, t4); \
+	load_frequent_const(post_filter_bitmatrix_s2, t3); \
+	load_frequent_const(post_filter_bitmatrix_s3, t7); \
+	\
+	/* prefilter sboxes */ \
+	vgf2p8affineqb128(pre_filter_constant_s1234, t5, x0, x0); \
+	vgf2p8affineqb128(pre_filter_constant_s1234, t5, x7, x7); \
+	vgf2p8affineqb128(pre_filter_constant_s1234, t2, x3, x3); \
+	vgf2p8affineqb128(pre_filter_constant_s1234, t2, x6, x6); \
+	vgf2p8affineqb128(pre_filter_constant_s1234, t5, x2, x2); \
+	vgf2p8affineqb128(pre_filter_constant_s1234, t5, x5, x5); \
+	vgf2p8affineqb128(pre_filter_constant_s1234, t5, x1, x1); \
+	vgf2p8affineqb128(pre_filter_constant_s1234, t5, x4, x4); \
+	\
+	/* sbox GF8 inverse + postfilter sboxes 1 and 4 */ \
+	vgf2p8affineinvqb128(post_filter_constant_s14, t4, x0, x0); \
+	vgf2p8affineinvqb128(post_filter_constant_s14, t4, x7, x7); \
+	vgf2p8affineinvqb128(post_filter_constant_s14, t4, x3, x3); \
+	vgf2p8affineinvqb128(post_filter_constant_s14, t4, x6, x6); \
+	\
+	/* sbox GF8 inverse + postfilter sbox 3 */ \
+	vgf2p8affineinvqb128(post_filter_constant_s3, t7, x2, x2); \
+	vgf2p8affineinvqb128(post_filter_constant_s3, t7, x5, x5); \
+	\
+	/* sbox GF8 inverse + postfilter sbox 2 */ \
+	vgf2p8affineinvqb128(post_filter_constant_s2, t3, x1, x1); \
+	vgf2p8affineinvqb128(post_filter_constant_s2, t3, x4, x4); \
+	\
+	vmovq128((key), t0); \
+	\
+	roundsm16_p_and_key(x0, x1, x2, x3, x4, x5, x6, x7, t0, t1, t2, t3, t4, \
+			    t5, t6, t7, mem_cd)
+
+#else /* USE_GFNI */
+
 /*
  * IN:
  *   x0..x7: byte-sliced AB state
@@ -433,63 +624,10 @@ static const uint8x16_t shift_row =
 	filter_8bit(x1, t4, t5, t7, t2); \
 	filter_8bit(x4, t4, t5, t7, t2); \
 	\
-	/* P-function */ \
-	vpxor128(x5, x0, x0); \
-	vpxor128(x6, x1, x1); \
-	vpxor128(x7, x2, x2); \
-	vpxor128(x4, x3, x3); \
-	\
-	vpxor128(x2, x4, x4); \
-	vpxor128(x3, x5, x5); \
-	vpxor128(x0, x6, x6); \
-	vpxor128(x1, x7, x7); \
-	\
-	vpxor128(x7, x0, x0); \
-	vpxor128(x4, x1, x1); \
-	vpxor128(x5, x2, x2); \
-	vpxor128(x6, x3, x3); \
-	\
-	vpxor128(x3, x4, x4); \
-	vpxor128(x0, x5, x5); \
-	vpxor128(x1, x6, x6); \
-	vpxor128(x2, x7, x7); /* note: high and low parts swapped */ \
-	\
-	/* Add key material and result to CD (x becomes new CD) */ \
-	\
-	vpshufb128(bcast[7], t0, t7); \
-	vpshufb128(bcast[6], t0, t6); \
-	vpshufb128(bcast[5], t0, t5); \
-	vpshufb128(bcast[4], t0, t4); \
-	vpshufb128(bcast[3], t0, t3); \
-	vpshufb128(bcast[2], t0, t2); \
-	vpshufb128(bcast[1], t0, t1); \
-	\
-	vpxor128(t3, x4, x4); \
-	vpxor128(mem_cd[0], x4, x4); \
-	\
-	load_zero(t3); \
-	vpshufb128(t3, t0, t0); \
-	\
-	vpxor128(t2, x5, x5); \
-	vpxor128(mem_cd[1], x5, x5); \
-	\
-	vpxor128(t1, x6, x6); \
-	vpxor128(mem_cd[2], x6, x6); \
-	\
-	vpxor128(t0, x7, x7); \
-	vpxor128(mem_cd[3], x7, x7); \
-	\
-	vpxor128(t7, x0, x0); \
-	vpxor128(mem_cd[4], x0, x0); \
-	\
-	vpxor128(t6, x1, x1); \
-	vpxor128(mem_cd[5], x1, x1); \
-	\
-	vpxor128(t5, x2, x2); \
-	vpxor128(mem_cd[6], x2, x2); \
-	\
-	vpxor128(t4, x3, x3); \
-	vpxor128(mem_cd[7], x3, x3);
+	roundsm16_p_and_key(x0, x1, x2, x3, x4, x5, x6, x7, t0, t1, t2, t3, t4, \
+			    t5, t6, t7, mem_cd)
+
+#endif /* USE_GFNI */
 
 /*
  * IN/OUT:
@@ -771,6 +909,174 @@ static const uint8x16_t shift_row =
 	vpxor128_memld((rio) + 14 * 16, x0, x1); \
 	vpxor128_memld((rio) + 15 * 16, x0, x0);
 
+/* load N first blocks to registers and apply pre-whitening, registers of
+ * blocks past N are set to whitening key */
+#define inpack16_pre_n(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+		       y5, y6, y7, rio, key, n) \
+	vmovq128((key), x0); \
+	vpshufb128(pack_bswap_stack, x0, x0); \
+	\
+	vpxor128_memld_blk(rio, 0, n, x0, y7); \
+	vpxor128_memld_blk(rio, 1, n, x0, y6); \
+	vpxor128_memld_blk(rio, 2, n, x0, y5); \
+	vpxor128_memld_blk(rio, 3, n, x0, y4); \
+	vpxor128_memld_blk(rio, 4, n, x0, y3); \
+	vpxor128_memld_blk(rio, 5, n, x0, y2); \
+	vpxor128_memld_blk(rio, 6, n, x0, y1); \
+	vpxor128_memld_blk(rio, 7, n, x0, y0); \
+	vpxor128_memld_blk(rio, 8, n, x0, x7); \
+	vpxor128_memld_blk(rio, 9, n, x0, x6); \
+	vpxor128_memld_blk(rio, 10, n, x0, x5); \
+	vpxor128_memld_blk(rio, 11, n, x0, x4); \
+	vpxor128_memld_blk(rio, 12, n, x0, x3); \
+	vpxor128_memld_blk(rio, 13, n, x0, x2); \
+	vpxor128_memld_blk(rio, 14, n, x0, x1); \
+	vpxor128_memld_blk(rio, 15, n, x0, x0);
+
+/* load IV and 15 first blocks from memory as CFB stream of previous
+ * ciphertext blocks and apply pre-whitening */
+#define inpack16_cfb_pre(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			 y5, y6, y7, rio, iv, key) \
+	vmovq128((key), x0); \
+	vpshufb128(pack_bswap_stack, x0, x0); \
+	\
+	vpxor128_memld((iv), x0, y7); \
+	vpxor128_memld((rio) + 0 * 16, x0, y6); \
+	vpxor128_memld((rio) + 1 * 16, x0, y5); \
+	vpxor128_memld((rio) + 2 * 16, x0, y4); \
+	vpxor128_memld((rio) + 3 * 16, x0, y3); \
+	vpxor128_memld((rio) + 4 * 16, x0, y2); \
+	vpxor128_memld((rio) + 5 * 16, x0, y1); \
+	vpxor128_memld((rio) + 6 * 16, x0, y0); \
+	vpxor128_memld((rio) + 7 * 16, x0, x7); \
+	vpxor128_memld((rio) + 8 * 16, x0, x6); \
+	vpxor128_memld((rio) + 9 * 16, x0, x5); \
+	vpxor128_memld((rio) + 10 * 16, x0, x4); \
+	vpxor128_memld((rio) + 11 * 16, x0, x3); \
+	vpxor128_memld((rio) + 12 * 16, x0, x2); \
+	vpxor128_memld((rio) + 13 * 16, x0, x1); \
+	vpxor128_memld((rio) + 14 * 16, x0, x0);
+
+/* multiply XTS tweak by x in GF(2^128), little-endian block order */
+#define gf128mul_x_le(iv, mask, tmp) \
+	vpsrad128(31, iv, tmp); \
+	vpaddq128(iv, iv, iv); \
+	vpshufd128_0x1b(tmp, tmp); \
+	vpand128(mask, tmp, tmp); \
+	vpxor128(tmp, iv, iv);
+
+#define xts_pre_blk(i, x, rio, tweaks, key, tw, mask, tmp) \
+	vmovdqa128(tw, tweaks[i]); \
+	vpxor128_memld((rio) + (i) * 16, tw, x); \
+	vpxor128(key, x, x); \
+	gf128mul_x_le(tw, mask, tmp);
+
+/* load 16 blocks from memory, XOR with successive XTS tweaks starting from
+ * TWEAK and apply pre-whitening, tweaks are stored to TWEAKS for output
+ * whitening and TWEAK is updated to next unused tweak */
+#define inpack16_xts_pre(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			 y5, y6, y7, rio, tweak, tweaks, key, t0, t1, t2, t3) \
+	vmovq128((key), t0); \
+	vpshufb128(pack_bswap_stack, t0, t0); \
+	vmovdqa128_memld(&xts_gfmul_and_mask, t2); \
+	vmovdqu128_memld(tweak, t1); \
+	\
+	xts_pre_blk(0, y7, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(1, y6, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(2, y5, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(3, y4, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(4, y3, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(5, y2, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(6, y1, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(7, y0, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(8, x7, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(9, x6, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(10, x5, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(11, x4, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(12, x3, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(13, x2, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(14, x1, rio, tweaks, t0, t1, t2, t3); \
+	xts_pre_blk(15, x0, rio, tweaks, t0, t1, t2, t3); \
+	\
+	vmovdqu128_memst(t1, tweak);
+
+#define ocb_pre_blk(i, x, rio, Ls, offs, key, offset) \
+	vpxor128_memld((Ls) + (i) * 16, offset, offs[i]); \
+	vpxor128_memld((rio) + (i) * 16, offs[i], x); \
+	vpxor128(key, x, x);
+
+/* load 16 blocks from memory, XOR with OCB offsets and apply pre-whitening.
+ * Offset of block i is OFFSET XOR LS[i], so all offsets are computed in
+ * parallel. Offsets are stored to OFFS for output whitening and OFFSET is
+ * updated to offset of last block */
+#define inpack16_ocb_pre(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			 y5, y6, y7, rio, offset, Ls, offs, key, t0, t1) \
+	vmovq128((key), t0); \
+	vpshufb128(pack_bswap_stack, t0, t0); \
+	vmovdqu128_memld(offset, t1); \
+	\
+	ocb_pre_blk(0, y7, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(1, y6, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(2, y5, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(3, y4, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(4, y3, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(5, y2, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(6, y1, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(7, y0, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(8, x7, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(9, x6, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(10, x5, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(11, x4, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(12, x3, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(13, x2, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(14, x1, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(15, x0, rio, Ls, offs, t0, t1); \
+	\
+	vmovdqu128_memst(offs[15], offset);
+
+/* XOR 16 blocks from memory to OCB checksum */
+#define ocb_checksum_input16(rio, checksum, t0, t1) \
+	vmovdqu128_memld((rio) + 0 * 16, t0); \
+	vmovdqu128_memld((rio) + 1 * 16, t1); \
+	vpxor128_memld((rio) + 2 * 16, t0, t0); \
+	vpxor128_memld((rio) + 3 * 16, t1, t1); \
+	vpxor128_memld((rio) + 4 * 16, t0, t0); \
+	vpxor128_memld((rio) + 5 * 16, t1, t1); \
+	vpxor128_memld((rio) + 6 * 16, t0, t0); \
+	vpxor128_memld((rio) + 7 * 16, t1, t1); \
+	vpxor128_memld((rio) + 8 * 16, t0, t0); \
+	vpxor128_memld((rio) + 9 * 16, t1, t1); \
+	vpxor128_memld((rio) + 10 * 16, t0, t0); \
+	vpxor128_memld((rio) + 11 * 16, t1, t1); \
+	vpxor128_memld((rio) + 12 * 16, t0, t0); \
+	vpxor128_memld((rio) + 13 * 16, t1, t1); \
+	vpxor128_memld((rio) + 14 * 16, t0, t0); \
+	vpxor128_memld((rio) + 15 * 16, t1, t1); \
+	vpxor128(t1, t0, t0); \
+	vpxor128_memld(checksum, t0, t0); \
+	vmovdqu128_memst(t0, checksum);
+
+/* XOR 16 blocks in registers to OCB checksum */
+#define ocb_checksum16(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+		       y5, y6, y7, checksum, t0, t1) \
+	vpxor128(x0, x1, t0); \
+	vpxor128(x2, x3, t1); \
+	vpxor128(x4, t0, t0); \
+	vpxor128(x5, t1, t1); \
+	vpxor128(x6, t0, t0); \
+	vpxor128(x7, t1, t1); \
+	vpxor128(y0, t0, t0); \
+	vpxor128(y1, t1, t1); \
+	vpxor128(y2, t0, t0); \
+	vpxor128(y3, t1, t1); \
+	vpxor128(y4, t0, t0); \
+	vpxor128(y5, t1, t1); \
+	vpxor128(y6, t0, t0); \
+	vpxor128(y7, t1, t1); \
+	vpxor128(t1, t0, t0); \
+	vpxor128_memld(checksum, t0, t0); \
+	vmovdqu128_memst(t0, checksum);
+
 /* byteslice pre-whitened blocks and store to temporary memory */
 #define inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, y5, \
 		      y6, y7, mem_ab, mem_cd) \
@@ -841,6 +1147,186 @@ static const uint8x16_t shift_row =
 	vmovdqu128_memst(y6, (rio) + 14 * 16); \
 	vmovdqu128_memst(y7, (rio) + 15 * 16);
 
+/* store N first blocks, blocks past N are not written */
+#define write_output_n(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+		       y5, y6, y7, rio, n) \
+	vmovdqu128_memst_blk(x0, rio, 0, n); \
+	vmovdqu128_memst_blk(x1, rio, 1, n); \
+	vmovdqu128_memst_blk(x2, rio, 2, n); \
+	vmovdqu128_memst_blk(x3, rio, 3, n); \
+	vmovdqu128_memst_blk(x4, rio, 4, n); \
+	vmovdqu128_memst_blk(x5, rio, 5, n); \
+	vmovdqu128_memst_blk(x6, rio, 6, n); \
+	vmovdqu128_memst_blk(x7, rio, 7, n); \
+	vmovdqu128_memst_blk(y0, rio, 8, n); \
+	vmovdqu128_memst_blk(y1, rio, 9, n); \
+	vmovdqu128_memst_blk(y2, rio, 10, n); \
+	vmovdqu128_memst_blk(y3, rio, 11, n); \
+	vmovdqu128_memst_blk(y4, rio, 12, n); \
+	vmovdqu128_memst_blk(y5, rio, 13, n); \
+	vmovdqu128_memst_blk(y6, rio, 14, n); \
+	vmovdqu128_memst_blk(y7, rio, 15, n);
+
+/* XOR 16 blocks from memory to registers, blocks are in write_output order */
+#define xor_input16(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, y5, \
+		    y6, y7, rio) \
+	vpxor128_memld((rio) + 0 * 16, x0, x0); \
+	vpxor128_memld((rio) + 1 * 16, x1, x1); \
+	vpxor128_memld((rio) + 2 * 16, x2, x2); \
+	vpxor128_memld((rio) + 3 * 16, x3, x3); \
+	vpxor128_memld((rio) + 4 * 16, x4, x4); \
+	vpxor128_memld((rio) + 5 * 16, x5, x5); \
+	vpxor128_memld((rio) + 6 * 16, x6, x6); \
+	vpxor128_memld((rio) + 7 * 16, x7, x7); \
+	vpxor128_memld((rio) + 8 * 16, y0, y0); \
+	vpxor128_memld((rio) + 9 * 16, y1, y1); \
+	vpxor128_memld((rio) + 10 * 16, y2, y2); \
+	vpxor128_memld((rio) + 11 * 16, y3, y3); \
+	vpxor128_memld((rio) + 12 * 16, y4, y4); \
+	vpxor128_memld((rio) + 13 * 16, y5, y5); \
+	vpxor128_memld((rio) + 14 * 16, y6, y6); \
+	vpxor128_memld((rio) + 15 * 16, y7, y7);
+
+/* XOR 16 blocks in registers with CBC chaining values, IV for first block and
+ * previous input block from memory for rest, blocks are in write_output order */
+#define xor_cbc_input16(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			y5, y6, y7, rio, iv) \
+	vpxor128_memld((iv), x0, x0); \
+	vpxor128_memld((rio) + 0 * 16, x1, x1); \
+	vpxor128_memld((rio) + 1 * 16, x2, x2); \
+	vpxor128_memld((rio) + 2 * 16, x3, x3); \
+	vpxor128_memld((rio) + 3 * 16, x4, x4); \
+	vpxor128_memld((rio) + 4 * 16, x5, x5); \
+	vpxor128_memld((rio) + 5 * 16, x6, x6); \
+	vpxor128_memld((rio) + 6 * 16, x7, x7); \
+	vpxor128_memld((rio) + 7 * 16, y0, y0); \
+	vpxor128_memld((rio) + 8 * 16, y1, y1); \
+	vpxor128_memld((rio) + 9 * 16, y2, y2); \
+	vpxor128_memld((rio) + 10 * 16, y3, y3); \
+	vpxor128_memld((rio) + 11 * 16, y4, y4); \
+	vpxor128_memld((rio) + 12 * 16, y5, y5); \
+	vpxor128_memld((rio) + 13 * 16, y6, y6); \
+	vpxor128_memld((rio) + 14 * 16, y7, y7);
+
+/* XOR 16 blocks in registers with XTS tweaks, blocks are in write_output
+ * order */
+#define xor_tweaks16(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, y5, \
+		     y6, y7, tweaks) \
+	vpxor128(tweaks[0], x0, x0); \
+	vpxor128(tweaks[1], x1, x1); \
+	vpxor128(tweaks[2], x2, x2); \
+	vpxor128(tweaks[3], x3, x3); \
+	vpxor128(tweaks[4], x4, x4); \
+	vpxor128(tweaks[5], x5, x5); \
+	vpxor128(tweaks[6], x6, x6); \
+	vpxor128(tweaks[7], x7, x7); \
+	vpxor128(tweaks[8], y0, y0); \
+	vpxor128(tweaks[9], y1, y1); \
+	vpxor128(tweaks[10], y2, y2); \
+	vpxor128(tweaks[11], y3, y3); \
+	vpxor128(tweaks[12], y4, y4); \
+	vpxor128(tweaks[13], y5, y5); \
+	vpxor128(tweaks[14], y6, y6); \
+	vpxor128(tweaks[15], y7, y7);
+
+/* generate 16 big-endian counter blocks to registers and apply
+ * pre-whitening, lowest counter byte must not overflow */
+#define inpack16_ctr_pre(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			 y5, y6, y7, iv, key, t0, t1) \
+	vmovdqu128_memld(iv, y7); \
+	vmovdqa128_memld(&bige_addb_1, t0); \
+	vmovdqa128_memld(&bige_addb_2, t1); \
+	vpaddb128(t0, y7, y6); \
+	vpaddb128(t1, y7, y5); \
+	vpaddb128(t1, y6, y4); \
+	vpaddb128(t1, y5, y3); \
+	vpaddb128(t1, y4, y2); \
+	vpaddb128(t1, y3, y1); \
+	vpaddb128(t1, y2, y0); \
+	vpaddb128(t1, y1, x7); \
+	vpaddb128(t1, y0, x6); \
+	vpaddb128(t1, x7, x5); \
+	vpaddb128(t1, x6, x4); \
+	vpaddb128(t1, x5, x3); \
+	vpaddb128(t1, x4, x2); \
+	vpaddb128(t1, x3, x1); \
+	vpaddb128(t1, x2, x0); \
+	\
+	vmovq128((key), t0); \
+	vpshufb128(pack_bswap_stack, t0, t0); \
+	\
+	vpxor128(t0, y7, y7); \
+	vpxor128(t0, y6, y6); \
+	vpxor128(t0, y5, y5); \
+	vpxor128(t0, y4, y4); \
+	vpxor128(t0, y3, y3); \
+	vpxor128(t0, y2, y2); \
+	vpxor128(t0, y1, y1); \
+	vpxor128(t0, y0, y0); \
+	vpxor128(t0, x7, x7); \
+	vpxor128(t0, x6, x6); \
+	vpxor128(t0, x5, x5); \
+	vpxor128(t0, x4, x4); \
+	vpxor128(t0, x3, x3); \
+	vpxor128(t0, x2, x2); \
+	vpxor128(t0, x1, x1); \
+	vpxor128(t0, x0, x0);
+
+/**********************************************************************
+  GHASH macros
+ **********************************************************************/
+/* multiply byte-reversed block X with byte-reversed hash key power H and
+ * accumulate unreduced 256-bit product to LO, MID and HI */
+#define ghash_mul_acc(x, h, lo, mid, hi, t0) \
+	vpclmulqdq128(0x00, h, x, t0); \
+	vpxor128(t0, lo, lo); \
+	vpclmulqdq128(0x11, h, x, t0); \
+	vpxor128(t0, hi, hi); \
+	vpclmulqdq128(0x01, h, x, t0); \
+	vpxor128(t0, mid, mid); \
+	vpclmulqdq128(0x10, h, x, t0); \
+	vpxor128(t0, mid, mid);
+
+/* reduce unreduced product LO, MID and HI of byte-reversed operands modulo
+ * GCM polynomial to O, clobbers LO and HI */
+#define ghash_reduce(lo, mid, hi, o, t0, t1, t2) \
+	vpslldq128(8, mid, t0); \
+	vpsrldq128(8, mid, t1); \
+	vpxor128(t0, lo, lo); \
+	vpxor128(t1, hi, hi); \
+	\
+	/* shift product left by one bit, operands are bit-reflected */ \
+	vpsrld128(31, lo, t0); \
+	vpsrld128(31, hi, t1); \
+	vpslld128(1, lo, lo); \
+	vpslld128(1, hi, hi); \
+	vpsrldq128(12, t0, t2); \
+	vpslldq128(4, t1, t1); \
+	vpslldq128(4, t0, t0); \
+	vpor128(t0, lo, lo); \
+	vpor128(t1, hi, hi); \
+	vpor128(t2, hi, hi); \
+	\
+	/* first phase of reduction */ \
+	vpslld128(31, lo, t0); \
+	vpslld128(30, lo, t1); \
+	vpslld128(25, lo, t2); \
+	vpxor128(t1, t0, t0); \
+	vpxor128(t2, t0, t0); \
+	vpsrldq128(4, t0, t1); \
+	vpslldq128(12, t0, t0); \
+	vpxor128(t0, lo, lo); \
+	\
+	/* second phase of reduction */ \
+	vpsrld128(1, lo, t2); \
+	vpsrld128(2, lo, t0); \
+	vpxor128(t0, t2, t2); \
+	vpsrld128(7, lo, t0); \
+	vpxor128(t0, t2, t2); \
+	vpxor128(t1, t2, t2); \
+	vpxor128(t2, lo, lo); \
+	vpxor128(lo, hi, o);
+
 /**********************************************************************
   macros for defining constant vectors
  **********************************************************************/
@@ -894,6 +1380,106 @@ static const __m128i bcast[8] =
   M128I_REP16(4), M128I_REP16(5), M128I_REP16(6), M128I_REP16(7)
 };
 
+#ifdef USE_GFNI
+#define BV8(a0,a1,a2,a3,a4,a5,a6,a7) \
+	( (((a0) & 1) << 0) | \
+	  (((a1) & 1) << 1) | \
+	  (((a2) & 1) << 2) | \
+	  (((a3) & 1) << 3) | \
+	  (((a4) & 1) << 4) | \
+	  (((a5) & 1) << 5) | \
+	  (((a6) & 1) << 6) | \
+	  (((a7) & 1) << 7) )
+
+#define BM8X8(l0,l1,l2,l3,l4,l5,l6,l7) \
+	( ((uint64_t)(l7) << (0 * 8)) | \
+	  ((uint64_t)(l6) << (1 * 8)) | \
+	  ((uint64_t)(l5) << (2 * 8)) | \
+	  ((uint64_t)(l4) << (3 * 8)) | \
+	  ((uint64_t)(l3) << (4 * 8)) | \
+	  ((uint64_t)(l2) << (5 * 8)) | \
+	  ((uint64_t)(l1) << (6 * 8)) | \
+	  ((uint64_t)(l0) << (7 * 8)) )
+
+#define M128I_REP64(x) { (x), (x) }
+
+/* Pre-filters and post-filters bit-matrixes and constants for Camellia sboxes
+ * s1, s2, s3 and s4.
+ *   See http://urn.fi/URN:NBN:fi:oulu-201305311409, pages 43-48.
+ *
+ * Pre-filters are directly from above source, "θ₁"/"θ₄". Post-filters are
+ * combination of function "A" (AES SubBytes affine transformation) and
+ * "ψ₁"/"ψ₂"/"ψ₃".
+ */
+
+/* Constant from "θ₁(x)" and "θ₄(x)" functions. */
+#define pre_filter_constant_s1234 BV8(1, 0, 1, 0, 0, 0, 1, 0)
+
+/* Constant from "ψ₁(A(x))" function: */
+#define post_filter_constant_s14  BV8(0, 1, 1, 1, 0, 1, 1, 0)
+
+/* Constant from "ψ₂(A(x))" function: */
+#define post_filter_constant_s2   BV8(0, 0, 1, 1, 1, 0, 1, 1)
+
+/* Constant from "ψ₃(A(x))" function: */
+#define post_filter_constant_s3   BV8(1, 1, 1, 0, 1, 1, 0, 0)
+
+/* Bit-matrix from "θ₁(x)" function: */
+static const __m128i pre_filter_bitmatrix_s123 =
+  M128I_REP64(BM8X8(BV8(1, 1, 1, 0, 1, 1, 0, 1),
+		    BV8(0, 0, 1, 1, 0, 0, 1, 0),
+		    BV8(1, 1, 0, 1, 0, 0, 0, 0),
+		    BV8(1, 0, 1, 1, 0, 0, 1, 1),
+		    BV8(0, 0, 0, 0, 1, 1, 0, 0),
+		    BV8(1, 0, 1, 0, 0, 1, 0, 0),
+		    BV8(0, 0, 1, 0, 1, 1, 0, 0),
+		    BV8(1, 0, 0, 0, 0, 1, 1, 0)));
+
+/* Bit-matrix from "θ₄(x)" function: */
+static const __m128i pre_filter_bitmatrix_s4 =
+  M128I_REP64(BM8X8(BV8(1, 1, 0, 1, 1, 0, 1, 1),
+		    BV8(0, 1, 1, 0, 0, 1, 0, 0),
+		    BV8(1, 0, 1, 0, 0, 0, 0, 1),
+		    BV8(0, 1, 1, 0, 0, 1, 1, 1),
+		    BV8(0, 0, 0, 1, 1, 0, 0, 0),
+		    BV8(0, 1, 0, 0, 1, 0, 0, 1),
+		    BV8(0, 1, 0, 1, 1, 0, 0, 0),
+		    BV8(0, 0, 0, 0, 1, 1, 0, 1)));
+
+/* Bit-matrix from "ψ₁(A(x))" function: */
+static const __m128i post_filter_bitmatrix_s14 =
+  M128I_REP64(BM8X8(BV8(0, 0, 0, 0, 0, 0, 0, 1),
+		    BV8(0, 1, 1, 0, 0, 1, 1, 0),
+		    BV8(1, 0, 1, 1, 1, 1, 1, 0),
+		    BV8(0, 0, 0, 1, 1, 0, 1, 1),
+		    BV8(1, 0, 0, 0, 1, 1, 1, 0),
+		    BV8(0, 1, 0, 1, 1, 1, 1, 0),
+		    BV8(0, 1, 1, 1, 1, 1, 1, 1),
+		    BV8(0, 0, 0, 1, 1, 1, 0, 0)));
+
+/* Bit-matrix from "ψ₂(A(x))" function: */
+static const __m128i post_filter_bitmatrix_s2 =
+  M128I_REP64(BM8X8(BV8(0, 0, 0, 1, 1, 1, 0, 0),
+		    BV8(0, 0, 0, 0, 0, 0, 0, 1),
+		    BV8(0, 1, 1, 0, 0, 1, 1, 0),
+		    BV8(1, 0, 1, 1, 1, 1, 1, 0),
+		    BV8(0, 0, 0, 1, 1, 0, 1, 1),
+		    BV8(1, 0, 0, 0, 1, 1, 1, 0),
+		    BV8(0, 1, 0, 1, 1, 1, 1, 0),
+		    BV8(0, 1, 1, 1, 1, 1, 1, 1)));
+
+/* Bit-matrix from "ψ₃(A(x))" function: */
+static const __m128i post_filter_bitmatrix_s3 =
+  M128I_REP64(BM8X8(BV8(0, 1, 1, 0, 0, 1, 1, 0),
+		    BV8(1, 0, 1, 1, 1, 1, 1, 0),
+		    BV8(0, 0, 0, 1, 1, 0, 1, 1),
+		    BV8(1, 0, 0, 0, 1, 1, 1, 0),
+		    BV8(0, 1, 0, 1, 1, 1, 1, 0),
+		    BV8(0, 1, 1, 1, 1, 1, 1, 1),
+		    BV8(0, 0, 0, 1, 1, 1, 0, 0),
+		    BV8(0, 0, 0, 0, 0, 0, 0, 1)));
+#endif /* USE_GFNI */
+
 /*
  * pre-SubByte transform
  *
@@ -916,6 +1502,7 @@ static const __m128i pre_tf_hi_s1 =
   M128I_BYTE(0x00, 0x51, 0xf1, 0xa0, 0x8a, 0xdb, 0x7b, 0x2a,
 	     0x09, 0x58, 0xf8, 0xa9, 0x83, 0xd2, 0x72, 0x23);
 
+#ifndef USE_GFNI
 /*
  * pre-SubByte transform
  *
@@ -937,6 +1524,7 @@ static const __m128i pre_tf_lo_s4 =
 static const __m128i pre_tf_hi_s4 =
   M128I_BYTE(0x00, 0xf1, 0x8a, 0x7b, 0x09, 0xf8, 0x83, 0x72,
 	     0xad, 0x5c, 0x27, 0xd6, 0xa4, 0x55, 0x2e, 0xdf);
+#endif
 
 /*
  * post-SubByte transform
@@ -958,79 +1546,442 @@ static const __m128i post_tf_lo_s1 =
   M128I_BYTE(0x3c, 0xcc, 0xcf, 0x3f, 0x32, 0xc2, 0xc1, 0x31,
 	     0xdc, 0x2c, 0x2f, 0xdf, 0xd2, 0x22, 0x21, 0xd1);
 
-static const __m128i post_tf_hi_s1 =
-  M128I_BYTE(0x00, 0xf9, 0x86, 0x7f, 0xd7, 0x2e, 0x51, 0xa8,
-	     0xa4, 0x5d, 0x22, 0xdb, 0x73, 0x8a, 0xf5, 0x0c);
+static const __m128i post_tf_hi_s1 =
+  M128I_BYTE(0x00, 0xf9, 0x86, 0x7f, 0xd7, 0x2e, 0x51, 0xa8,
+	     0xa4, 0x5d, 0x22, 0xdb, 0x73, 0x8a, 0xf5, 0x0c);
+
+#ifndef USE_GFNI
+/*
+ * post-SubByte transform
+ *
+ * post-lookup for sbox2:
+ *  swap_bitendianness(
+ *      camellia_h(
+ *          isom_map_aes_to_camellia(
+ *              swap_bitendianness(
+ *                  aes_inverse_affine_transform(in)
+ *              )
+ *          )
+ *      )
+ *  ) <<< 1
+ *
+ * (note: '⊕ 0x6e' inside camellia_h())
+ */
+static const __m128i post_tf_lo_s2 =
+  M128I_BYTE(0x78, 0x99, 0x9f, 0x7e, 0x64, 0x85, 0x83, 0x62,
+	     0xb9, 0x58, 0x5e, 0xbf, 0xa5, 0x44, 0x42, 0xa3);
+
+static const __m128i post_tf_hi_s2 =
+  M128I_BYTE(0x00, 0xf3, 0x0d, 0xfe, 0xaf, 0x5c, 0xa2, 0x51,
+	     0x49, 0xba, 0x44, 0xb7, 0xe6, 0x15, 0xeb, 0x18);
+
+/*
+ * post-SubByte transform
+ *
+ * post-lookup for sbox3:
+ *  swap_bitendianness(
+ *      camellia_h(
+ *          isom_map_aes_to_camellia(
+ *              swap_bitendianness(
+ *                  aes_inverse_affine_transform(in)
+ *              )
+ *          )
+ *      )
+ *  ) >>> 1
+ *
+ * (note: '⊕ 0x6e' inside camellia_h())
+ */
+static const __m128i post_tf_lo_s3 =
+  M128I_BYTE(0x1e, 0x66, 0xe7, 0x9f, 0x19, 0x61, 0xe0, 0x98,
+	     0x6e, 0x16, 0x97, 0xef, 0x69, 0x11, 0x90, 0xe8);
+
+static const __m128i post_tf_hi_s3 =
+  M128I_BYTE(0x00, 0xfc, 0x43, 0xbf, 0xeb, 0x17, 0xa8, 0x54,
+	     0x52, 0xae, 0x11, 0xed, 0xb9, 0x45, 0xfa, 0x06);
+#endif
+
+#ifndef USE_GFNI
+/* For isolating SubBytes from AESENCLAST, inverse shift row */
+static const __m128i inv_shift_row =
+  M128I_BYTE(0x00, 0x0d, 0x0a, 0x07, 0x04, 0x01, 0x0e, 0x0b,
+	     0x08, 0x05, 0x02, 0x0f, 0x0c, 0x09, 0x06, 0x03);
+#endif
+
+/* 4-bit mask */
+static const __m128i mask_0f =
+  M128I_U32(0x0f0f0f0f, 0x0f0f0f0f, 0x0f0f0f0f, 0x0f0f0f0f);
+
+/* For CTR-mode, byte additions to lowest byte of big-endian counter */
+static const __m128i bige_addb_1 =
+  M128I_BYTE(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1);
+
+static const __m128i bige_addb_2 =
+  M128I_BYTE(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2);
+
+/* For XTS-mode, reduction constants for tweak multiplication by x */
+static const __m128i xts_gfmul_and_mask =
+  M128I_U32(0x87, 0, 1, 0);
+
+static const __m128i bswap128_mask =
+  M128I_BYTE(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+/* Generates NBLKS big-endian counter blocks from CTR to DST and increments
+ * CTR by NBLKS. */
+static void ctr_gen_blks(uint8_t *dst, uint8_t *ctr, unsigned int nblks)
+{
+  unsigned int i, j;
+
+  for (i = 0; i < nblks; i++) {
+    for (j = 0; j < 16; j++)
+      dst[i * 16 + j] = ctr[j];
+
+    /* increment big-endian counter */
+    for (j = 16; j > 0; j--) {
+      if (++ctr[j - 1] != 0)
+	break;
+    }
+  }
+}
+
+/*
+ * IN:
+ *  x0..x15: 16 pre-whitened input blocks from inpack16_pre
+ * OUT:
+ *  x0..x15: 16 encrypted blocks, in write_output order:
+ *           7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+ */
+#define enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		  x13, x14, x15, ab, cd, tmp0, tmp1, k, lastk) \
+	inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		      x13, x14, x15, ab, cd); \
+	\
+	k = 0; \
+	while (1) { \
+	  enc_rounds16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		       x13, x14, x15, ab, cd, k); \
+	  \
+	  if (k == lastk - 8) \
+	    break; \
+	  \
+	  fls16(ab, x0, x1, x2, x3, x4, x5, x6, x7, cd, x8, x9, x10, x11, x12, \
+		x13, x14, x15, &ctx->key_table[k + 8], &ctx->key_table[k + 9]); \
+	  \
+	  k += 8; \
+	} \
+	\
+	/* load CD for output */ \
+	vmovdqa128(cd[0], x8); \
+	vmovdqa128(cd[1], x9); \
+	vmovdqa128(cd[2], x10); \
+	vmovdqa128(cd[3], x11); \
+	vmovdqa128(cd[4], x12); \
+	vmovdqa128(cd[5], x13); \
+	vmovdqa128(cd[6], x14); \
+	vmovdqa128(cd[7], x15); \
+	\
+	outunpack16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, \
+		    x14, x15, ctx->key_table[lastk], tmp0, tmp1);
+
+/*
+ * IN:
+ *  x0..x15: 16 pre-whitened input blocks from inpack16_pre
+ * OUT:
+ *  x0..x15: 16 decrypted blocks, in write_output order:
+ *           7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+ */
+#define dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		  x13, x14, x15, ab, cd, tmp0, tmp1, k, firstk) \
+	inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		      x13, x14, x15, ab, cd); \
+	\
+	k = firstk - 8; \
+	while (1) { \
+	  dec_rounds16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		       x13, x14, x15, ab, cd, k); \
+	  \
+	  if (k == 0) \
+	    break; \
+	  \
+	  fls16(ab, x0, x1, x2, x3, x4, x5, x6, x7, cd, x8, x9, x10, x11, x12, \
+		x13, x14, x15, &ctx->key_table[k + 1], &ctx->key_table[k]); \
+	  \
+	  k -= 8; \
+	} \
+	\
+	/* load CD for output */ \
+	vmovdqa128(cd[0], x8); \
+	vmovdqa128(cd[1], x9); \
+	vmovdqa128(cd[2], x10); \
+	vmovdqa128(cd[3], x11); \
+	vmovdqa128(cd[4], x12); \
+	vmovdqa128(cd[5], x13); \
+	vmovdqa128(cd[6], x14); \
+	vmovdqa128(cd[7], x15); \
+	\
+	outunpack16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, \
+		    x14, x15, ctx->key_table[0], tmp0, tmp1);
+
+/* Encrypts 16 input block from IN and writes result to OUT. IN and OUT may
+ * unaligned pointers. */
+void camellia_encrypt_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i tmp0, tmp1;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	       x15, in, ctx->key_table[0]);
+
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
+
+/* Decrypts 16 input block from IN and writes result to OUT. IN and OUT may
+ * unaligned pointers. */
+void camellia_decrypt_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i tmp0, tmp1;
+  unsigned int firstk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    firstk = 32;
+  else
+    firstk = 24;
+
+  inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	       x15, in, ctx->key_table[firstk]);
+
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
+
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
+
+/* Encrypts NBLKS (1 to 16) input blocks from IN and writes result to OUT.
+ * Blocks past NBLKS are not read or written. IN and OUT may unaligned
+ * pointers. */
+void camellia_encrypt_nblks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				    const void *vin, unsigned int nblks)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i tmp0, tmp1;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  inpack16_pre_n(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		 x14, x15, in, ctx->key_table[0], nblks);
+
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  write_output_n(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+		 x9, x8, out, nblks);
+}
+
+/* Decrypts NBLKS (1 to 16) input blocks from IN and writes result to OUT.
+ * Blocks past NBLKS are not read or written. IN and OUT may unaligned
+ * pointers. */
+void camellia_decrypt_nblks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				    const void *vin, unsigned int nblks)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i tmp0, tmp1;
+  unsigned int firstk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    firstk = 32;
+  else
+    firstk = 24;
+
+  inpack16_pre_n(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		 x14, x15, in, ctx->key_table[firstk], nblks);
+
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
+
+  write_output_n(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+		 x9, x8, out, nblks);
+}
+
+/* Encrypts 16 big-endian counter blocks starting from IV, XORs result with
+ * 16 input blocks from IN and writes result to OUT. IV is incremented by 16.
+ * IN and OUT may unaligned pointers. */
+void camellia_ctr_enc_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *viv)
+{
+  char *out = vout;
+  const char *in = vin;
+  uint8_t *iv = viv;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i tmp0, tmp1;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  if (iv[15] <= 0xff - 16) {
+    /* Counter additions do not overflow the lowest byte, generate counter
+     * blocks with byte additions in registers. */
+    inpack16_ctr_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12,
+		     x13, x14, x15, iv, ctx->key_table[0], tmp0, tmp1);
+    iv[15] += 16;
+  } else {
+    /* Handle carry propagation through whole 128-bit counter. */
+    uint8_t ctrblks[16 * 16];
+
+    ctr_gen_blks(ctrblks, iv, 16);
+    inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		 x14, x15, ctrblks, ctx->key_table[0]);
+  }
+
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  xor_input16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	      x8, in);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
+
+/* Decrypts 16 input blocks from IN in CBC mode and writes result to OUT. IV
+ * is XORed to first decrypted block and is replaced with last input block.
+ * IN and OUT may unaligned pointers and may point to same buffer. */
+void camellia_cbc_dec_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *iv)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i tmp0, tmp1;
+  unsigned int firstk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
 
-/*
- * post-SubByte transform
- *
- * post-lookup for sbox2:
- *  swap_bitendianness(
- *      camellia_h(
- *          isom_map_aes_to_camellia(
- *              swap_bitendianness(
- *                  aes_inverse_affine_transform(in)
- *              )
- *          )
- *      )
- *  ) <<< 1
- *
- * (note: '⊕ 0x6e' inside camellia_h())
- */
-static const __m128i post_tf_lo_s2 =
-  M128I_BYTE(0x78, 0x99, 0x9f, 0x7e, 0x64, 0x85, 0x83, 0x62,
-	     0xb9, 0x58, 0x5e, 0xbf, 0xa5, 0x44, 0x42, 0xa3);
+  if (ctx->key_length > 16)
+    firstk = 32;
+  else
+    firstk = 24;
 
-static const __m128i post_tf_hi_s2 =
-  M128I_BYTE(0x00, 0xf3, 0x0d, 0xfe, 0xaf, 0x5c, 0xa2, 0x51,
-	     0x49, 0xba, 0x44, 0xb7, 0xe6, 0x15, 0xeb, 0x18);
+  inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	       x15, in, ctx->key_table[firstk]);
 
-/*
- * post-SubByte transform
- *
- * post-lookup for sbox3:
- *  swap_bitendianness(
- *      camellia_h(
- *          isom_map_aes_to_camellia(
- *              swap_bitendianness(
- *                  aes_inverse_affine_transform(in)
- *              )
- *          )
- *      )
- *  ) >>> 1
- *
- * (note: '⊕ 0x6e' inside camellia_h())
- */
-static const __m128i post_tf_lo_s3 =
-  M128I_BYTE(0x1e, 0x66, 0xe7, 0x9f, 0x19, 0x61, 0xe0, 0x98,
-	     0x6e, 0x16, 0x97, 0xef, 0x69, 0x11, 0x90, 0xe8);
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
 
-static const __m128i post_tf_hi_s3 =
-  M128I_BYTE(0x00, 0xfc, 0x43, 0xbf, 0xeb, 0x17, 0xa8, 0x54,
-	     0x52, 0xae, 0x11, 0xed, 0xb9, 0x45, 0xfa, 0x06);
+  /* Load chaining values before output overwrites input in-place. */
+  vmovdqu128_memld(in + 15 * 16, tmp0);
+  xor_cbc_input16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+		  x9, x8, in, iv);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+  vmovdqu128_memst(tmp0, iv);
+}
 
-/* For isolating SubBytes from AESENCLAST, inverse shift row */
-static const __m128i inv_shift_row =
-  M128I_BYTE(0x00, 0x0d, 0x0a, 0x07, 0x04, 0x01, 0x0e, 0x0b,
-	     0x08, 0x05, 0x02, 0x0f, 0x0c, 0x09, 0x06, 0x03);
+/* Decrypts 16 input blocks from IN in CFB mode and writes result to OUT.
+ * IV and 15 first input blocks are encrypted and XORed with input blocks. IV
+ * is replaced with last input block. IN and OUT may unaligned pointers and
+ * may point to same buffer. */
+void camellia_cfb_dec_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *iv)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i tmp0, tmp1;
+  unsigned int lastk, k;
+  frequent_constants_declare;
 
-/* 4-bit mask */
-static const __m128i mask_0f =
-  M128I_U32(0x0f0f0f0f, 0x0f0f0f0f, 0x0f0f0f0f, 0x0f0f0f0f);
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
 
+  inpack16_cfb_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, iv, ctx->key_table[0]);
 
-/* Encrypts 16 input block from IN and writes result to OUT. IN and OUT may
- * unaligned pointers. */
-void camellia_encrypt_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
-				     const void *vin)
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  /* Load next IV before output overwrites input in-place. */
+  vmovdqu128_memld(in + 15 * 16, tmp0);
+  xor_input16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	      x8, in);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+  vmovdqu128_memst(tmp0, iv);
+}
+
+/* Encrypts 16 input blocks from IN in XTS mode and writes result to OUT.
+ * TWEAK is encrypted tweak for first block and is updated to tweak for next
+ * block. IN and OUT may unaligned pointers and may point to same buffer. */
+void camellia_xts_enc_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *tweak)
 {
   char *out = vout;
   const char *in = vin;
   __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
   __m128i ab[8];
   __m128i cd[8];
-  __m128i tmp0, tmp1;
+  __m128i tweaks[16];
+  __m128i tmp0, tmp1, tmp2, tmp3;
   unsigned int lastk, k;
   frequent_constants_declare;
 
@@ -1041,53 +1992,111 @@ void camellia_encrypt_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
   else
     lastk = 24;
 
-  inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-	       x15, in, ctx->key_table[0]);
+  inpack16_xts_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, tweak, tweaks, ctx->key_table[0], tmp0, tmp1,
+		   tmp2, tmp3);
 
-  inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-		x15, ab, cd);
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
 
-  k = 0;
-  while (1) {
-    enc_rounds16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-	         x15, ab, cd, k);
+  xor_tweaks16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+	       x9, x8, tweaks);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
 
-    if (k == lastk - 8)
-      break;
+/* Decrypts 16 input blocks from IN in XTS mode and writes result to OUT.
+ * TWEAK is encrypted tweak for first block and is updated to tweak for next
+ * block. IN and OUT may unaligned pointers and may point to same buffer. */
+void camellia_xts_dec_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *tweak)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i tweaks[16];
+  __m128i tmp0, tmp1, tmp2, tmp3;
+  unsigned int firstk, k;
+  frequent_constants_declare;
 
-    fls16(ab, x0, x1, x2, x3, x4, x5, x6, x7, cd, x8, x9, x10, x11, x12, x13, x14,
-	  x15, &ctx->key_table[k + 8], &ctx->key_table[k + 9]);
+  prepare_frequent_constants();
 
-    k += 8;
-  }
+  if (ctx->key_length > 16)
+    firstk = 32;
+  else
+    firstk = 24;
 
-  /* load CD for output */
-  vmovdqa128(cd[0], x8);
-  vmovdqa128(cd[1], x9);
-  vmovdqa128(cd[2], x10);
-  vmovdqa128(cd[3], x11);
-  vmovdqa128(cd[4], x12);
-  vmovdqa128(cd[5], x13);
-  vmovdqa128(cd[6], x14);
-  vmovdqa128(cd[7], x15);
+  inpack16_xts_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, tweak, tweaks, ctx->key_table[firstk], tmp0,
+		   tmp1, tmp2, tmp3);
 
-  outunpack16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-	      x15, ctx->key_table[lastk], tmp0, tmp1);
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
 
+  xor_tweaks16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+	       x9, x8, tweaks);
   write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
 	       x8, out);
 }
 
-/* Decrypts 16 input block from IN and writes result to OUT. IN and OUT may
- * unaligned pointers. */
-void camellia_decrypt_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
-				     const void *vin)
+/* Encrypts 16 input blocks from IN in OCB mode and writes result to OUT.
+ * OFFSET is offset of previous block and LS is array of 16 offset deltas, so
+ * that offset of block i is OFFSET XOR LS[i]. OFFSET is updated to offset of
+ * last block and input blocks are XORed to CHECKSUM. IN and OUT may
+ * unaligned pointers and may point to same buffer. */
+void camellia_ocb_enc_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *offset,
+				     void *checksum, const void *vLs)
+{
+  char *out = vout;
+  const char *in = vin;
+  const char *Ls = vLs;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i offs[16];
+  __m128i tmp0, tmp1;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  ocb_checksum_input16(in, checksum, tmp0, tmp1);
+  inpack16_ocb_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, offset, Ls, offs, ctx->key_table[0], tmp0,
+		   tmp1);
+
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  xor_tweaks16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+	       x9, x8, offs);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
+
+/* Decrypts 16 input blocks from IN in OCB mode and writes result to OUT.
+ * OFFSET and LS are as for camellia_ocb_enc_16blks_simd128. OFFSET is updated
+ * to offset of last block and output blocks are XORed to CHECKSUM. IN and OUT
+ * may unaligned pointers and may point to same buffer. */
+void camellia_ocb_dec_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *offset,
+				     void *checksum, const void *vLs)
 {
   char *out = vout;
   const char *in = vin;
+  const char *Ls = vLs;
   __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
   __m128i ab[8];
   __m128i cd[8];
+  __m128i offs[16];
   __m128i tmp0, tmp1;
   unsigned int firstk, k;
   frequent_constants_declare;
@@ -1099,39 +2108,157 @@ void camellia_decrypt_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
   else
     firstk = 24;
 
-  inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-	       x15, in, ctx->key_table[firstk]);
+  inpack16_ocb_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, offset, Ls, offs, ctx->key_table[firstk], tmp0,
+		   tmp1);
+
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
+
+  xor_tweaks16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+	       x9, x8, offs);
+  ocb_checksum16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+		 x9, x8, checksum, tmp0, tmp1);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
 
-  inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-		x15, ab, cd);
+/* GHASH of NBLKS (1 to 16) blocks from IN with single reduction. HASH is
+ * byte-reversed hash state and HTABLE is table of byte-reversed hash key
+ * powers H^16, ..., H^1. If REFLECT is zero, input blocks are not
+ * byte-reflected, which gives POLYVAL instead (RFC 8452, Appendix A). */
+static inline __m128i ghash_blks16(__m128i hash, const char *in,
+				   unsigned int nblks, const char *Htable,
+				   int reflect)
+{
+  __m128i lo, mid, hi, x, h, bswap, t0, t1, t2;
+  unsigned int i;
+
+  vmovdqa128_memld(&bswap128_mask, bswap);
+  Htable += (16 - nblks) * 16;
+
+  vmovdqu128_memld(in, x);
+  if (reflect)
+    vpshufb128(bswap, x, x);
+  vpxor128(hash, x, x);
+  vmovdqu128_memld(Htable, h);
+  vpclmulqdq128(0x00, h, x, lo);
+  vpclmulqdq128(0x11, h, x, hi);
+  vpclmulqdq128(0x01, h, x, mid);
+  vpclmulqdq128(0x10, h, x, t0);
+  vpxor128(t0, mid, mid);
+
+  for (i = 1; i < nblks; i++) {
+    vmovdqu128_memld(in + i * 16, x);
+    if (reflect)
+      vpshufb128(bswap, x, x);
+    vmovdqu128_memld(Htable + i * 16, h);
+    ghash_mul_acc(x, h, lo, mid, hi, t0);
+  }
 
-  k = firstk - 8;
-  while (1) {
-    dec_rounds16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
-		 x14, x15, ab, cd, k);
+  ghash_reduce(lo, mid, hi, hash, t0, t1, t2);
+  return hash;
+}
 
-    if (k == 0)
-      break;
+/* Updates GHASH state HASH with NBLKS blocks from IN. HTABLE is table of
+ * byte-reversed hash key powers H^16, ..., H^1. Blocks are processed 16 at a
+ * time with single reduction per 16 blocks. */
+void camellia_ghash_simd128(void *vhash, const void *Htable, const void *vin,
+			    size_t nblks)
+{
+  const char *in = vin;
+  __m128i hash, bswap;
+  unsigned int n;
+
+  vmovdqa128_memld(&bswap128_mask, bswap);
+  vmovdqu128_memld(vhash, hash);
+  vpshufb128(bswap, hash, hash);
+
+  while (nblks) {
+    n = nblks > 16 ? 16 : nblks;
+    hash = ghash_blks16(hash, in, n, Htable, 1);
+    in += n * 16;
+    nblks -= n;
+  }
+
+  vpshufb128(bswap, hash, hash);
+  vmovdqu128_memst(hash, vhash);
+}
+
+/* Updates POLYVAL state HASH with NBLKS blocks from IN. HTABLE is table of
+ * hash key powers in same form as for camellia_ghash_simd128, for key of the
+ * equivalent GHASH. */
+void camellia_polyval_simd128(void *vhash, const void *Htable,
+			      const void *vin, size_t nblks)
+{
+  const char *in = vin;
+  __m128i hash;
+  unsigned int n;
 
-    fls16(ab, x0, x1, x2, x3, x4, x5, x6, x7, cd, x8, x9, x10, x11, x12, x13,
-	  x14, x15, &ctx->key_table[k + 1], &ctx->key_table[k]);
+  vmovdqu128_memld(vhash, hash);
 
-    k -= 8;
+  while (nblks) {
+    n = nblks > 16 ? 16 : nblks;
+    hash = ghash_blks16(hash, in, n, Htable, 0);
+    in += n * 16;
+    nblks -= n;
   }
 
-  /* load CD for output */
-  vmovdqa128(cd[0], x8);
-  vmovdqa128(cd[1], x9);
-  vmovdqa128(cd[2], x10);
-  vmovdqa128(cd[3], x11);
-  vmovdqa128(cd[4], x12);
-  vmovdqa128(cd[5], x13);
-  vmovdqa128(cd[6], x14);
-  vmovdqa128(cd[7], x15);
+  vmovdqu128_memst(hash, vhash);
+}
+
+/* Encrypts 16 big-endian counter blocks starting from IV, XORs result with
+ * 16 input blocks from IN and writes result to OUT, as
+ * camellia_ctr_enc_16blks_simd128. GHASH state HASH is updated with 16 blocks
+ * from GHASH_IN, which are read before OUT is written. IN, OUT and GHASH_IN
+ * may unaligned pointers. */
+void camellia_gcm_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				 const void *vin, void *viv, void *vhash,
+				 const void *Htable, const void *ghash_in)
+{
+  char *out = vout;
+  const char *in = vin;
+  uint8_t *iv = viv;
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m128i ab[8];
+  __m128i cd[8];
+  __m128i tmp0, tmp1;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  /* GHASH does not depend on cipher state, so carry-less multiplications
+   * can execute in parallel with counter generation and first rounds. */
+  vmovdqa128_memld(&bswap128_mask, tmp1);
+  vmovdqu128_memld(vhash, tmp0);
+  vpshufb128(tmp1, tmp0, tmp0);
+  tmp0 = ghash_blks16(tmp0, ghash_in, 16, Htable, 1);
+  vpshufb128(tmp1, tmp0, tmp0);
+  vmovdqu128_memst(tmp0, vhash);
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  if (iv[15] <= 0xff - 16) {
+    inpack16_ctr_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12,
+		     x13, x14, x15, iv, ctx->key_table[0], tmp0, tmp1);
+    iv[15] += 16;
+  } else {
+    uint8_t ctrblks[16 * 16];
+
+    ctr_gen_blks(ctrblks, iv, 16);
+    inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		 x14, x15, ctrblks, ctx->key_table[0]);
+  }
 
-  outunpack16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-	      x15, ctx->key_table[0], tmp0, tmp1);
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
 
+  xor_input16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	      x8, in);
   write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
 	       x8, out);
 }
@@ -1227,9 +2354,6 @@ void camellia_decrypt_16blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
 		    (((b0) & 0xffffffffULL) << 32)) \
 	)
 
-static const __m128i bswap128_mask =
-  M128I_BYTE(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
-
 static const __m128i inv_shift_row_and_unpcklbw =
   M128I_BYTE(0x00, 0xff, 0x0d, 0xff, 0x0a, 0xff, 0x07, 0xff,
 	     0x04, 0xff, 0x01, 0xff, 0x0e, 0xff, 0x0b, 0xff);
@@ -2162,3 +3286,365 @@ int camellia_keysetup_simd128(struct camellia_simd_ctx *ctx, const void *vkey,
   ctx->key_length = keylen;
   return 0;
 }
+
+/********* 1-way block functions **********************************************/
+
+/* Converts subkey from key_table format to 64-bit integer format of
+ * camellia_f(). */
+#define key_f(k) (((k) >> 32) | ((k) << 32))
+
+/* sp0222 and sp3033 masks of camellia_f() combined with
+ * inv_shift_row_and_unpcklbw, for use on postfiltered sbox 2 and sbox 3
+ * outputs. */
+static const __m128i sp0222_s2mask =
+  M128I_U32(0xff070707, 0xff070707, 0x0e0effff, 0xff0e0e0e);
+
+static const __m128i sp3033_s3mask =
+  M128I_U32(0x0aff0a0a, 0x0aff0a0a, 0xff0101ff, 0x01ff0101);
+
+/* P-function of camellia_f_blk, on postfiltered sbox outputs in AES shift
+ * rows order: T1 for sboxes 1 and 4, T3 for sbox 2 and T0 for sbox 3. */
+#define camellia_p_blk(x, t0, t1, t2, t3) \
+	vpshufb128_amemld(&sp0044440444044404mask, t1, t2); \
+	vpshufb128_amemld(&sp1110111010011110mask, t1, t1); \
+	vpshufb128_amemld(&sp0222_s2mask, t3, t3); \
+	vpshufb128_amemld(&sp3033_s3mask, t0, t0); \
+	vpxor128(t2, t1, t1); \
+	vpxor128(t3, t0, t0); \
+	vpxor128(t1, t0, x);
+
+#ifdef USE_GFNI
+
+/* Selects sbox 4 prefiltered bytes from high 64 bits and applies AES shift
+ * rows, so that sbox outputs are in same order as with AES subbytes. */
+static const __m128i sbox4_select_and_shift_row =
+  M128I_BYTE(0x00, 0x05, 0x0a, 0x0f, 0x0c, 0x09, 0x0e, 0x03,
+	     0x08, 0x0d, 0x02, 0x07, 0x0c, 0x09, 0x06, 0x0b);
+
+/*
+ * Camellia F-function, 1-way GFNI. As AES subbytes version below, but
+ * sboxes 1, 2 and 3 prefilter and sbox 4 prefilter are done in parallel on
+ * low and high 64 bits, and sbox GF8 inverse is merged with postfilters.
+ *
+ * IN:
+ *  ab: 64-bit AB state
+ * OUT:
+ *  x: F(AB) as XOR of low and high 64 bits
+ */
+#define camellia_f_blk(ab, x, t0, t1, t2, t3, t4) \
+	/* prefilter sboxes 1, 2 and 3, and sbox 4 */ \
+	vpunpcklqdq128(ab, ab, x); \
+	vgf2p8affineqb128(pre_filter_constant_s1234, pre_s123_s4_bitmatrix, x, \
+			  x); \
+	vpshufb128(sbox4_shuf_mask, x, x); \
+	\
+	/* sbox GF8 inverse + postfilter sboxes 1 and 4, sbox 2 and sbox 3 */ \
+	vgf2p8affineinvqb128(post_filter_constant_s14, post_s14_bitmatrix, x, \
+			     t1); \
+	vgf2p8affineinvqb128(post_filter_constant_s2, post_s2_bitmatrix, x, t3); \
+	vgf2p8affineinvqb128(post_filter_constant_s3, post_s3_bitmatrix, x, t0); \
+	\
+	camellia_p_blk(x, t0, t1, t2, t3);
+
+#define blkn_declare \
+	__m128i x, t0, t1, t2, t3; \
+	__m128i bswap, sbox4_shuf_mask, pre_s123_s4_bitmatrix; \
+	__m128i post_s14_bitmatrix, post_s2_bitmatrix, post_s3_bitmatrix; \
+	unsigned int k, lastk
+
+#define prepare_blkn_constants() \
+	vmovdqa128_memld(&bswap128_mask, bswap); \
+	vmovdqa128_memld(&sbox4_select_and_shift_row, sbox4_shuf_mask); \
+	vmovdqa128_memld(&pre_filter_bitmatrix_s123, t0); \
+	vmovdqa128_memld(&pre_filter_bitmatrix_s4, t1); \
+	vpunpcklqdq128(t1, t0, pre_s123_s4_bitmatrix); \
+	vmovdqa128_memld(&post_filter_bitmatrix_s14, post_s14_bitmatrix); \
+	vmovdqa128_memld(&post_filter_bitmatrix_s2, post_s2_bitmatrix); \
+	vmovdqa128_memld(&post_filter_bitmatrix_s3, post_s3_bitmatrix);
+
+#else /* USE_GFNI */
+
+/*
+ * Camellia F-function, 1-way SIMD/AESNI. As camellia_f(), but input
+ * rotation of sbox 4 and output rotations of sbox 2 and 3 are done with
+ * separate pre- and postfilters (as in 16-way roundsm16) for shorter
+ * dependency chain, and without key XOR, which is end of F-function.
+ *
+ * IN:
+ *  ab: 64-bit AB state
+ * OUT:
+ *  x: F(AB) as XOR of low and high 64 bits
+ */
+#define camellia_f_blk(ab, x, t0, t1, t2, t3, t4) \
+	/* prefilter sboxes 1, 2 and 3, and sbox 4 */ \
+	vpand128(ab, _0f0f0f0fmask, t0); \
+	if_vpsrlb128(vpsrlb128(4, ab, t1)); \
+	if_not_vpsrlb128(vpandn128(ab, _0f0f0f0fmask, t1)); \
+	if_not_vpsrlb128(vpsrld128(4, t1, t1)); \
+	vpshufb128(t0, pre_s1lo_mask, t2); \
+	vpshufb128(t1, pre_s1hi_mask, x); \
+	vpshufb128(t0, pre_s4lo_mask, t0); \
+	vpshufb128(t1, pre_s4hi_mask, t1); \
+	vpxor128(t2, x, x); \
+	vpxor128(t0, t1, t1); \
+	vpandn128(x, sbox4mask, x); \
+	vpand128(t1, sbox4mask, t1); \
+	vpor128(t1, x, x); \
+	\
+	/* AES subbytes + AES shift rows */ \
+	aes_subbytes_and_shuf_and_xor(zero, x, x); \
+	\
+	/* postfilter sboxes 1 and 4, sbox 2 (<<< 1) and sbox 3 (>>> 1) */ \
+	vpand128(x, _0f0f0f0fmask, t0); \
+	if_vpsrlb128(vpsrlb128(4, x, x)); \
+	if_not_vpsrlb128(vpandn128(x, _0f0f0f0fmask, x)); \
+	if_not_vpsrlb128(vpsrld128(4, x, x)); \
+	vpshufb128(t0, post_s1lo_mask, t1); \
+	vpshufb128(x, post_s1hi_mask, t2); \
+	vpshufb128(t0, post_s2lo_mask, t3); \
+	vpshufb128(x, post_s2hi_mask, t4); \
+	vpshufb128(t0, post_s3lo_mask, t0); \
+	vpshufb128(x, post_s3hi_mask, x); \
+	vpxor128(t1, t2, t1); \
+	vpxor128(t3, t4, t3); \
+	vpxor128(t0, x, t0); \
+	\
+	camellia_p_blk(x, t0, t1, t2, t3);
+
+#define blkn_declare \
+	__m128i x, t0, t1, t2, t3, t4; \
+	__m128i bswap, zero, sbox4mask, _0f0f0f0fmask; \
+	__m128i pre_s1lo_mask, pre_s1hi_mask, pre_s4lo_mask, pre_s4hi_mask; \
+	__m128i post_s1lo_mask, post_s1hi_mask, post_s2lo_mask, post_s2hi_mask; \
+	__m128i post_s3lo_mask, post_s3hi_mask; \
+	unsigned int k, lastk
+
+#define prepare_blkn_constants() \
+	vmovdqa128_memld(&bswap128_mask, bswap); \
+	load_zero(zero); \
+	vmovq128(sbox4_input_mask, sbox4mask); \
+	vmovdqa128_memld(&mask_0f, _0f0f0f0fmask); \
+	vmovdqa128_memld(&pre_tf_lo_s1, pre_s1lo_mask); \
+	vmovdqa128_memld(&pre_tf_hi_s1, pre_s1hi_mask); \
+	vmovdqa128_memld(&pre_tf_lo_s4, pre_s4lo_mask); \
+	vmovdqa128_memld(&pre_tf_hi_s4, pre_s4hi_mask); \
+	vmovdqa128_memld(&post_tf_lo_s1, post_s1lo_mask); \
+	vmovdqa128_memld(&post_tf_hi_s1, post_s1hi_mask); \
+	vmovdqa128_memld(&post_tf_lo_s2, post_s2lo_mask); \
+	vmovdqa128_memld(&post_tf_hi_s2, post_s2hi_mask); \
+	vmovdqa128_memld(&post_tf_lo_s3, post_s3lo_mask); \
+	vmovdqa128_memld(&post_tf_hi_s3, post_s3hi_mask);
+
+#endif /* USE_GFNI */
+
+/* Applies macro M to AB and CD states of each block. */
+#define for_each_blk1(m, ...) \
+	m(ab0, cd0, 0, __VA_ARGS__)
+
+#define for_each_blk2(m, ...) \
+	for_each_blk1(m, __VA_ARGS__); \
+	m(ab1, cd1, 1, __VA_ARGS__)
+
+#define for_each_blk4(m, ...) \
+	for_each_blk2(m, __VA_ARGS__); \
+	m(ab2, cd2, 2, __VA_ARGS__); \
+	m(ab3, cd3, 3, __VA_ARGS__)
+
+/* load block I, byte-swap to 64-bit AB and CD states and apply
+ * pre-whitening */
+#define inpack1(ab, cd, i, in, key) \
+	vmovdqu128_memld((in) + (i) * 16, cd); \
+	vpshufb128(bswap, cd, cd); \
+	vpsrldq128(8, cd, ab); \
+	vpxor128(key, ab, ab);
+
+/* apply post-whitening, swap halves and store block I */
+#define outunpack1(ab, cd, i, out, key) \
+	vpxor128(key, cd, cd); \
+	vpunpcklqdq128(cd, ab, cd); \
+	vpshufb128(bswap, cd, cd); \
+	vmovdqu128_memst(cd, (out) + (i) * 16);
+
+/* key is added to CD in parallel with S-function */
+#define f_ab_to_cd(ab, cd, i, key) \
+	vmovq128(key_f(key), x); \
+	vpxor128(x, cd, cd); \
+	camellia_f_blk(ab, x, t0, t1, t2, t3, t4); \
+	vpsrldq128(8, x, t0); \
+	vpxor128(x, cd, cd); \
+	vpxor128(t0, cd, cd);
+
+#define f_cd_to_ab(ab, cd, i, key) \
+	f_ab_to_cd(cd, ab, i, key)
+
+/*
+ * IN/OUT:
+ *  ab: 64-bit AB state
+ *  cd: 64-bit CD state
+ */
+#define fls1(ab, cd, i, kl, kr) \
+	/* \
+	 * abr ^= rol32(abl & kll, 1); \
+	 * abl ^= abr | klr; \
+	 */ \
+	vmovq128(key_f(kl), t0); \
+	vpand128(ab, t0, t1); \
+	vpslld128(1, t1, t2); \
+	vpsrld128(31, t1, t1); \
+	vpor128(t2, t1, t1); \
+	vpsrlq128(32, t1, t1); \
+	vpxor128(t1, ab, ab); \
+	vpor128(ab, t0, t1); \
+	vpsllq128(32, t1, t1); \
+	vpxor128(t1, ab, ab); \
+	\
+	/* \
+	 * cdl ^= cdr | krr; \
+	 * cdr ^= rol32(cdl & krl, 1); \
+	 */ \
+	vmovq128(key_f(kr), t0); \
+	vpor128(cd, t0, t1); \
+	vpsllq128(32, t1, t1); \
+	vpxor128(t1, cd, cd); \
+	vpand128(cd, t0, t1); \
+	vpslld128(1, t1, t2); \
+	vpsrld128(31, t1, t1); \
+	vpor128(t2, t1, t1); \
+	vpsrlq128(32, t1, t1); \
+	vpxor128(t1, cd, cd);
+
+#define enc_rounds1(for_each_blk, i) \
+	for_each_blk(f_ab_to_cd, ctx->key_table[(i) + 2]); \
+	for_each_blk(f_cd_to_ab, ctx->key_table[(i) + 3]); \
+	for_each_blk(f_ab_to_cd, ctx->key_table[(i) + 4]); \
+	for_each_blk(f_cd_to_ab, ctx->key_table[(i) + 5]); \
+	for_each_blk(f_ab_to_cd, ctx->key_table[(i) + 6]); \
+	for_each_blk(f_cd_to_ab, ctx->key_table[(i) + 7]);
+
+#define dec_rounds1(for_each_blk, i) \
+	for_each_blk(f_ab_to_cd, ctx->key_table[(i) + 7]); \
+	for_each_blk(f_cd_to_ab, ctx->key_table[(i) + 6]); \
+	for_each_blk(f_ab_to_cd, ctx->key_table[(i) + 5]); \
+	for_each_blk(f_cd_to_ab, ctx->key_table[(i) + 4]); \
+	for_each_blk(f_ab_to_cd, ctx->key_table[(i) + 3]); \
+	for_each_blk(f_cd_to_ab, ctx->key_table[(i) + 2]);
+
+/* Blocks are processed with 1-way F-function of key-setup, rounds of blocks
+ * interleaved. */
+#define enc_blkn(for_each_blk, out, in) \
+	if (ctx->key_length > 16) \
+	  lastk = 32; \
+	else \
+	  lastk = 24; \
+	\
+	prepare_blkn_constants(); \
+	\
+	vmovq128(key_f(ctx->key_table[0]), t0); \
+	for_each_blk(inpack1, in, t0); \
+	\
+	k = 0; \
+	while (1) { \
+	  enc_rounds1(for_each_blk, k); \
+	  \
+	  if (k == lastk - 8) \
+	    break; \
+	  \
+	  for_each_blk(fls1, ctx->key_table[k + 8], ctx->key_table[k + 9]); \
+	  \
+	  k += 8; \
+	} \
+	\
+	vmovq128(key_f(ctx->key_table[lastk]), t0); \
+	for_each_blk(outunpack1, out, t0);
+
+#define dec_blkn(for_each_blk, out, in) \
+	if (ctx->key_length > 16) \
+	  lastk = 32; \
+	else \
+	  lastk = 24; \
+	\
+	prepare_blkn_constants(); \
+	\
+	vmovq128(key_f(ctx->key_table[lastk]), t0); \
+	for_each_blk(inpack1, in, t0); \
+	\
+	k = lastk - 8; \
+	while (1) { \
+	  dec_rounds1(for_each_blk, k); \
+	  \
+	  if (k == 0) \
+	    break; \
+	  \
+	  for_each_blk(fls1, ctx->key_table[k + 1], ctx->key_table[k]); \
+	  \
+	  k -= 8; \
+	} \
+	\
+	vmovq128(key_f(ctx->key_table[0]), t0); \
+	for_each_blk(outunpack1, out, t0);
+
+void camellia_encrypt_1blk_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				   const void *vin)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i ab0, cd0;
+  blkn_declare;
+
+  enc_blkn(for_each_blk1, out, in);
+}
+
+void camellia_decrypt_1blk_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				   const void *vin)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i ab0, cd0;
+  blkn_declare;
+
+  dec_blkn(for_each_blk1, out, in);
+}
+
+void camellia_encrypt_2blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				    const void *vin)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i ab0, cd0, ab1, cd1;
+  blkn_declare;
+
+  enc_blkn(for_each_blk2, out, in);
+}
+
+void camellia_decrypt_2blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				    const void *vin)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i ab0, cd0, ab1, cd1;
+  blkn_declare;
+
+  dec_blkn(for_each_blk2, out, in);
+}
+
+void camellia_encrypt_4blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				    const void *vin)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i ab0, cd0, ab1, cd1, ab2, cd2, ab3, cd3;
+  blkn_declare;
+
+  enc_blkn(for_each_blk4, out, in);
+}
+
+void camellia_decrypt_4blks_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				    const void *vin)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m128i ab0, cd0, ab1, cd1, ab2, cd2, ab3, cd3;
+  blkn_declare;
+
+  dec_blkn(for_each_blk4, out, in);
+}
@@ -28,13 +28,24 @@
 
 #define vpsrld256(s, a, o)      (o = _mm256_srli_epi32(a, s))
 #define vpsrldq256(s, a, o)     (o = _mm256_srli_si256(a, s))
+#define vpsllq256(s, a, o)      (o = _mm256_slli_epi64(a, s))
+#define vpsrad256(s, a, o)      (o = _mm256_srai_epi32(a, s))
 
 #define vpaddb256(a, b, o)      (o = _mm256_add_epi8(b, a))
+#define vpaddq256(a, b, o)      (o = _mm256_add_epi64(b, a))
 
 #define vpcmpgtb256(a, b, o)    (o = _mm256_cmpgt_epi8(b, a))
 #define vpabsb256(a, o)         (o = _mm256_abs_epi8(a))
 
+#ifdef __AVX512VL__
+ /* AVX512VL has three-input bitwise ternary logic instruction. */
+ #define vpternlogq256(imm, c, b, a, o) \
+	(o = _mm256_ternarylogic_epi64(a, b, c, imm))
+#endif
+
 #define vpshufb256(m, a, o)     (o = _mm256_shuffle_epi8(a, m))
+#define vpshufd256_0x1b(a, o)   (o = _mm256_shuffle_epi32(a, 0x1b))
+#define vpblendd256_0xf0(a, b, o) (o = _mm256_blend_epi32(b, a, 0xf0))
 
 #define vpunpckhdq256(a, b, o)  (o = _mm256_unpackhi_epi32(b, a))
 #define vpunpckldq256(a, b, o)  (o = _mm256_unpacklo_epi32(b, a))
@@ -50,16 +61,86 @@
  #define vaesenclast128(a, b, o) (o = _mm_aesenclast_si128(b, a))
 #endif
 
+#if defined(__VPCLMULQDQ__)
+ /* VPCLMULQDQ has 256-bit wide carry-less multiply. */
+ #define vpclmulqdq256(imm, a, b, o) (o = _mm256_clmulepi64_epi128(b, a, imm))
+#else
+ /* PCLMUL/AVX2 only has 128-bit wide carry-less multiply, split 256-bit
+  * vector into two 128-bit and perform PCLMUL on those, then merge result. */
+ #define vpclmulqdq256(imm, a, b, o) ({ \
+	    __m128i __clmul_lo = _mm_clmulepi64_si128( \
+				    _mm256_castsi256_si128(b), \
+				    _mm256_castsi256_si128(a), imm); \
+	    __m128i __clmul_hi = _mm_clmulepi64_si128( \
+				    _mm256_extracti128_si256(b, 1), \
+				    _mm256_extracti128_si256(a, 1), imm); \
+	    o = _mm256_inserti128_si256(_mm256_castsi128_si256(__clmul_lo), \
+					__clmul_hi, 1); \
+	  })
+#endif
+
+#define vpxor128(a, b, o)       (o = _mm_xor_si128(b, a))
+#define vpor128(a, b, o)        (o = _mm_or_si128(b, a))
+#define vpsrld128(s, a, o)      (o = _mm_srli_epi32(a, s))
+#define vpslld128(s, a, o)      (o = _mm_slli_epi32(a, s))
+#define vpsrldq128(s, a, o)     (o = _mm_srli_si128(a, s))
+#define vpslldq128(s, a, o)     (o = _mm_slli_si128(a, s))
+#define vpshufb128(m, a, o)     (o = _mm_shuffle_epi8(a, m))
+
 #define vmovdqa256(a, o)        (o = a)
 #define vmovd128_si256(a, o)    (o = _mm256_set_epi32(0, 0, 0, a, 0, 0, 0, a))
 #define vmovq128_si256(a, o)    (o = _mm256_set_epi64x(0, a, 0, a))
 
 #define vpbroadcastq(a, o)      (o = _mm256_set1_epi64x(a))
+#define vbroadcasti128_memld(a, o) \
+	(o = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(a))))
 
 /* Following operations may have unaligned memory input/output */
+#define vmovdqa256_memld(a, o)  (o = (*(const __m256i *)(a)))
 #define vmovdqu256_memst(a, o)  _mm256_storeu_si256((__m256i *)(o), a)
 #define vpxor256_memld(a, b, o) \
 	vpxor256(b, _mm256_loadu_si256((const __m256i *)(a)), o)
+#define vinserti128_memld(lo, hi, o) \
+	(o = _mm256_inserti128_si256( \
+		_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(lo))), \
+		_mm_loadu_si128((const __m128i *)(hi)), 1))
+#define vmovdqu128_memld(a, o)  (o = _mm_loadu_si128((const __m128i *)(a)))
+#define vmovdqu128_memst(a, o)  _mm_storeu_si128((__m128i *)(o), a)
+#define vpxor128_memld(a, b, o) \
+	(o = _mm_xor_si128(b, _mm_loadu_si128((const __m128i *)(a))))
+#define vmovdqu256_lo128_memst(a, o) \
+	vmovdqu128_memst(_mm256_castsi256_si128(a), o)
+#define vmovdqu256_hi128_memst(a, o) \
+	vmovdqu128_memst(_mm256_extracti128_si256(a, 1), o)
+#define vmovdqu256_memld(a, o)  (o = _mm256_loadu_si256((const __m256i *)(a)))
+#define vpxor256_fold128(a, o) \
+	(o = _mm_xor_si128(_mm256_castsi256_si128(a), \
+			   _mm256_extracti128_si256(a, 1)))
+
+/* Masked load/store of block pair I (blocks 2*I and 2*I+1). NVEC holds
+ * block count N in each 64-bit element, blocks past N are not accessed. */
+#define blk2_index256(i) \
+	_mm256_set_epi64x(2 * (i) + 1, 2 * (i) + 1, 2 * (i), 2 * (i))
+#ifdef __AVX512VL__
+ /* AVX512VL has mask registers and masked loads and stores. */
+ #define vpxor256_memld_blk2(rio, i, nvec, a, o) \
+	vpxor256(a, _mm256_maskz_loadu_epi64( \
+			_mm256_cmpgt_epi64_mask(nvec, blk2_index256(i)), \
+			(rio) + (i) * 32), o)
+ #define vmovdqu256_memst_blk2(a, rio, i, nvec) \
+	_mm256_mask_storeu_epi64((rio) + (i) * 32, \
+				 _mm256_cmpgt_epi64_mask(nvec, \
+							 blk2_index256(i)), a)
+#else
+ /* AVX2 has masked loads and stores with vector mask. */
+ #define vpxor256_memld_blk2(rio, i, nvec, a, o) \
+	vpxor256(a, _mm256_maskload_epi64( \
+			(const long long *)((rio) + (i) * 32), \
+			_mm256_cmpgt_epi64(nvec, blk2_index256(i))), o)
+ #define vmovdqu256_memst_blk2(a, rio, i, nvec) \
+	_mm256_maskstore_epi64((long long *)((rio) + (i) * 32), \
+			       _mm256_cmpgt_epi64(nvec, blk2_index256(i)), a)
+#endif
 
 #ifndef USE_GFNI
   /* Macros for exposing SubBytes from AES-NI/VAES instruction sets. */
@@ -81,7 +162,7 @@
 	  })
   #endif
   #define aes_load_inv_shufmask(shufmask_reg) \
-	vmovdqa256(inv_shift_row, shufmask_reg)
+	load_frequent_const(inv_shift_row, shufmask_reg)
   #define aes_inv_shuf(shufmask_reg, a, o) \
 	vpshufb256(shufmask_reg, a, o)
 #endif /* !USE_GFNI */
@@ -171,6 +252,80 @@
 
 #define load_zero(o) (o = _mm256_set_epi64x(0, 0, 0, 0))
 
+#ifdef __AVX512VL__
+/* o = a ^ b ^ c */
+#define vpxor3_256(a, b, c, o)  vpternlogq256(0x96, c, b, a, o)
+/* o = a ^ (b | c) */
+#define vpxor_or256(a, b, c, o) vpternlogq256(0x1e, c, b, a, o)
+#else
+#define vpxor3_256(a, b, c, o) \
+	(o = _mm256_xor_si256(_mm256_xor_si256(a, b), c))
+#define vpxor_or256(a, b, c, o) \
+	(o = _mm256_xor_si256(a, _mm256_or_si256(b, c)))
+#endif
+
+/**********************************************************************
+  round constants
+ **********************************************************************/
+
+/* Constants used by every round are loaded once per call to *_stack
+ * variables. Barrier hides their origin from compiler, so that they are
+ * kept in registers or spilled once to stack, instead of being reloaded
+ * from constant pool with separate load instruction in each round.
+ *
+ * GFNI round only keeps two most used bit-matrices this way. Other three
+ * are used as memory operand of affine instruction without extra load, and
+ * pinning those to registers too makes compiler spill round state. */
+#define memory_barrier_with_vec(a) __asm__("" : "+x"(a) :: "memory")
+
+#define load_frequent_const(constant, o) vmovdqa256(constant ## _stack, o)
+
+#define prepare_frequent_const(constant) \
+	vmovdqa256(constant, constant ## _stack); \
+	memory_barrier_with_vec(constant ## _stack)
+
+#define prepare_frequent_const_bcastq(constant) \
+	vpbroadcastq(constant, constant ## _stack); \
+	memory_barrier_with_vec(constant ## _stack)
+
+#ifdef USE_GFNI
+#define prepare_frequent_constants() \
+	prepare_frequent_const_bcastq(pre_filter_bitmatrix_s123); \
+	prepare_frequent_const_bcastq(post_filter_bitmatrix_s14)
+
+#define frequent_constants_declare \
+	__m256i pre_filter_bitmatrix_s123_stack; \
+	__m256i post_filter_bitmatrix_s14_stack
+#else /* USE_GFNI */
+#define prepare_frequent_constants() \
+	prepare_frequent_const(inv_shift_row); \
+	prepare_frequent_const(mask_0f); \
+	prepare_frequent_const(pre_tf_lo_s1); \
+	prepare_frequent_const(pre_tf_hi_s1); \
+	prepare_frequent_const(pre_tf_lo_s4); \
+	prepare_frequent_const(pre_tf_hi_s4); \
+	prepare_frequent_const(post_tf_lo_s1); \
+	prepare_frequent_const(post_tf_hi_s1); \
+	prepare_frequent_const(post_tf_lo_s3); \
+	prepare_frequent_const(post_tf_hi_s3); \
+	prepare_frequent_const(post_tf_lo_s2); \
+	prepare_frequent_const(post_tf_hi_s2)
+
+#define frequent_constants_declare \
+	__m256i inv_shift_row_stack; \
+	__m256i mask_0f_stack; \
+	__m256i pre_tf_lo_s1_stack; \
+	__m256i pre_tf_hi_s1_stack; \
+	__m256i pre_tf_lo_s4_stack; \
+	__m256i pre_tf_hi_s4_stack; \
+	__m256i post_tf_lo_s1_stack; \
+	__m256i post_tf_hi_s1_stack; \
+	__m256i post_tf_lo_s3_stack; \
+	__m256i post_tf_hi_s3_stack; \
+	__m256i post_tf_lo_s2_stack; \
+	__m256i post_tf_hi_s2_stack
+#endif /* USE_GFNI */
+
 /**********************************************************************
   16-way camellia macros
  **********************************************************************/
@@ -178,7 +333,13 @@
 #ifdef USE_GFNI
 
 /*
- * AES-NI/VAES version of round function.
+ * GFNI version of round function.
+ *
+ * Post-filter of round and pre-filter of next round are not merged to
+ * one affine step. Doing so needs both halves kept in pre-filtered form
+ * (new CD is XOR of old CD and P-function output), and FL/FL⁻¹ needs
+ * plain bytes, so every six rounds sixteen conversions in and out are
+ * needed and these cost as much as the removed pre-filters.
  *
  * IN:
  *   x0..x7: byte-sliced AB state
@@ -192,9 +353,9 @@
 	/* \
 	 * S-function with GFNI \
 	 */ \
-	vpbroadcastq(pre_filter_bitmatrix_s123, t5); \
+	load_frequent_const(pre_filter_bitmatrix_s123, t5); \
 	vpbroadcastq(pre_filter_bitmatrix_s4, t2); \
-	vpbroadcastq(post_filter_bitmatrix_s14, t4); \
+	load_frequent_const(post_filter_bitmatrix_s14, t4); \
 	vpbroadcastq(post_filter_bitmatrix_s2, t3); \
 	vpbroadcastq(post_filter_bitmatrix_s3, t7); \
 	load_zero(t6); \
@@ -260,33 +421,25 @@
 	\
 	/* Add key material and result to CD (x becomes new CD) */ \
 	\
-	vpxor256(t3, x4, x4); \
-	vpxor256(mem_cd[0], x4, x4); \
+	vpxor3_256(x4, t3, mem_cd[0], x4); \
 	\
-	vpxor256(t2, x5, x5); \
-	vpxor256(mem_cd[1], x5, x5); \
+	vpxor3_256(x5, t2, mem_cd[1], x5); \
 	\
 	vpsrldq256(1, t5, t3); \
 	vpshufb256(t6, t5, t5); \
 	vpshufb256(t6, t3, t6); \
 	\
-	vpxor256(t1, x6, x6); \
-	vpxor256(mem_cd[2], x6, x6); \
+	vpxor3_256(x6, t1, mem_cd[2], x6); \
 	\
-	vpxor256(t0, x7, x7); \
-	vpxor256(mem_cd[3], x7, x7); \
+	vpxor3_256(x7, t0, mem_cd[3], x7); \
 	\
-	vpxor256(t7, x0, x0); \
-	vpxor256(mem_cd[4], x0, x0); \
+	vpxor3_256(x0, t7, mem_cd[4], x0); \
 	\
-	vpxor256(t6, x1, x1); \
-	vpxor256(mem_cd[5], x1, x1); \
+	vpxor3_256(x1, t6, mem_cd[5], x1); \
 	\
-	vpxor256(t5, x2, x2); \
-	vpxor256(mem_cd[6], x2, x2); \
+	vpxor3_256(x2, t5, mem_cd[6], x2); \
 	\
-	vpxor256(t4, x3, x3); \
-	vpxor256(mem_cd[7], x3, x3);
+	vpxor3_256(x3, t4, mem_cd[7], x3);
 
 #else /* USE_GFNI */
 
@@ -306,9 +459,9 @@
 	 * S-function with AES subbytes \
 	 */ \
 	aes_load_inv_shufmask(t4); \
-	vmovdqa256(mask_0f, t7); \
-	vmovdqa256(pre_tf_lo_s1, t0); \
-	vmovdqa256(pre_tf_hi_s1, t1); \
+	load_frequent_const(mask_0f, t7); \
+	load_frequent_const(pre_tf_lo_s1, t0); \
+	load_frequent_const(pre_tf_hi_s1, t1); \
 	\
 	/* AES inverse shift rows */ \
 	aes_inv_shuf(t4, x0, x0); \
@@ -321,8 +474,8 @@
 	aes_inv_shuf(t4, x6, x6); \
 	\
 	/* prefilter sboxes 1, 2 and 3 */ \
-	vmovdqa256(pre_tf_lo_s4, t2); \
-	vmovdqa256(pre_tf_hi_s4, t3); \
+	load_frequent_const(pre_tf_lo_s4, t2); \
+	load_frequent_const(pre_tf_hi_s4, t3); \
 	filter_8bit(x0, t0, t1, t7, t6); \
 	filter_8bit(x7, t0, t1, t7, t6); \
 	filter_8bit(x1, t0, t1, t7, t6); \
@@ -336,8 +489,8 @@
 	filter_8bit(x6, t2, t3, t7, t6); \
 	\
 	/* AES subbytes + AES shift rows */ \
-	vmovdqa256(post_tf_lo_s1, t0); \
-	vmovdqa256(post_tf_hi_s1, t1); \
+	load_frequent_const(post_tf_lo_s1, t0); \
+	load_frequent_const(post_tf_hi_s1, t1); \
 	aes_subbytes_and_shuf_and_xor(t4, x0, x0); \
 	aes_subbytes_and_shuf_and_xor(t4, x7, x7); \
 	aes_subbytes_and_shuf_and_xor(t4, x1, x1); \
@@ -348,16 +501,16 @@
 	aes_subbytes_and_shuf_and_xor(t4, x6, x6); \
 	\
 	/* postfilter sboxes 1 and 4 */ \
-	vmovdqa256(post_tf_lo_s3, t2); \
-	vmovdqa256(post_tf_hi_s3, t3); \
+	load_frequent_const(post_tf_lo_s3, t2); \
+	load_frequent_const(post_tf_hi_s3, t3); \
 	filter_8bit(x0, t0, t1, t7, t6); \
 	filter_8bit(x7, t0, t1, t7, t6); \
 	filter_8bit(x3, t0, t1, t7, t6); \
 	filter_8bit(x6, t0, t1, t7, t6); \
 	\
 	/* postfilter sbox 3 */ \
-	vmovdqa256(post_tf_lo_s2, t4); \
-	vmovdqa256(post_tf_hi_s2, t5); \
+	load_frequent_const(post_tf_lo_s2, t4); \
+	load_frequent_const(post_tf_hi_s2, t5); \
 	filter_8bit(x2, t2, t3, t7, t6); \
 	filter_8bit(x5, t2, t3, t7, t6); \
 	\
@@ -398,32 +551,24 @@
 	vpshufb256(bcast[2], t0, t2); \
 	vpshufb256(bcast[1], t0, t1); \
 	\
-	vpxor256(t3, x4, x4); \
-	vpxor256(mem_cd[0], x4, x4); \
+	vpxor3_256(x4, t3, mem_cd[0], x4); \
 	\
 	load_zero(t3); \
 	vpshufb256(t3, t0, t0); \
 	\
-	vpxor256(t2, x5, x5); \
-	vpxor256(mem_cd[1], x5, x5); \
+	vpxor3_256(x5, t2, mem_cd[1], x5); \
 	\
-	vpxor256(t1, x6, x6); \
-	vpxor256(mem_cd[2], x6, x6); \
+	vpxor3_256(x6, t1, mem_cd[2], x6); \
 	\
-	vpxor256(t0, x7, x7); \
-	vpxor256(mem_cd[3], x7, x7); \
+	vpxor3_256(x7, t0, mem_cd[3], x7); \
 	\
-	vpxor256(t7, x0, x0); \
-	vpxor256(mem_cd[4], x0, x0); \
+	vpxor3_256(x0, t7, mem_cd[4], x0); \
 	\
-	vpxor256(t6, x1, x1); \
-	vpxor256(mem_cd[5], x1, x1); \
+	vpxor3_256(x1, t6, mem_cd[5], x1); \
 	\
-	vpxor256(t5, x2, x2); \
-	vpxor256(mem_cd[6], x2, x2); \
+	vpxor3_256(x2, t5, mem_cd[6], x2); \
 	\
-	vpxor256(t4, x3, x3); \
-	vpxor256(mem_cd[7], x3, x3);
+	vpxor3_256(x3, t4, mem_cd[7], x3);
 
 #endif /* USE_GFNI */
 
@@ -512,6 +657,42 @@
 	vpor256(t2, v3, v3); \
 	vpor256(t0, v0, v0);
 
+/*
+ * IN:
+ *  v0..3: byte-sliced 32-bit integers
+ *  o0..3: byte-sliced 32-bit integers
+ * OUT:
+ *  o0..3: o ^ (v <<< 1)
+ */
+#if defined(USE_GFNI) && defined(__AVX512VL__)
+/* Carry bits are moved from bit 7 to bit 0 with GFNI affine transform and
+ * merged to output with three-input XOR. */
+#define rol32_1_xor_16(v0, v1, v2, v3, o0, o1, o2, o3, t0, t1, t2, zero) \
+	vpbroadcastq(shr7_bitmatrix, t0); \
+	vgf2p8affineqb(0, t0, v0, t1); \
+	vgf2p8affineqb(0, t0, v1, t2); \
+	vpaddb256(v0, v0, v0); \
+	vpaddb256(v1, v1, v1); \
+	vpxor3_256(o1, v1, t1, o1); \
+	\
+	vgf2p8affineqb(0, t0, v2, t1); \
+	vpaddb256(v2, v2, v2); \
+	vpxor3_256(o2, v2, t2, o2); \
+	\
+	vgf2p8affineqb(0, t0, v3, t2); \
+	vpaddb256(v3, v3, v3); \
+	vpxor3_256(o3, v3, t1, o3); \
+	vpxor3_256(o0, v0, t2, o0);
+#else
+#define rol32_1_xor_16(v0, v1, v2, v3, o0, o1, o2, o3, t0, t1, t2, zero) \
+	rol32_1_16(v0, v1, v2, v3, t0, t1, t2, zero); \
+	\
+	vpxor256(v0, o0, o0); \
+	vpxor256(v1, o1, o1); \
+	vpxor256(v2, o2, o2); \
+	vpxor256(v3, o3, o3);
+#endif
+
 /*
  * IN:
  *   r: byte-sliced AB state in memory
@@ -538,15 +719,11 @@
 	vpand256(l2, t2, t2); \
 	vpand256(l3, t3, t3); \
 	\
-	rol32_1_16(t3, t2, t1, t0, tt1, tt2, tt3, tt0); \
+	rol32_1_xor_16(t3, t2, t1, t0, l7, l6, l5, l4, tt1, tt2, tt3, tt0); \
 	\
-	vpxor256(l4, t0, l4); \
 	vmovdqa256(l4, l[4]); \
-	vpxor256(l5, t1, l5); \
 	vmovdqa256(l5, l[5]); \
-	vpxor256(l6, t2, l6); \
 	vmovdqa256(l6, l[6]); \
-	vpxor256(l7, t3, l7); \
 	vmovdqa256(l7, l[7]); \
 	\
 	/* \
@@ -561,19 +738,10 @@
 	vpshufb256(bcast[2], t0, t1); \
 	vpshufb256(bcast[3], t0, t0); \
 	\
-	vpor256(r[4], t0, t0); \
-	vpor256(r[5], t1, t1); \
-	vpor256(r[6], t2, t2); \
-	vpor256(r[7], t3, t3); \
-	\
-	vpxor256(r[0], t0, t0); \
-	vpxor256(r[1], t1, t1); \
-	vpxor256(r[2], t2, t2); \
-	vpxor256(r[3], t3, t3); \
-	vmovdqa256(t0, r[0]); \
-	vmovdqa256(t1, r[1]); \
-	vmovdqa256(t2, r[2]); \
-	vmovdqa256(t3, r[3]); \
+	vpxor_or256(r[0], r[4], t0, r[0]); \
+	vpxor_or256(r[1], r[5], t1, r[1]); \
+	vpxor_or256(r[2], r[6], t2, r[2]); \
+	vpxor_or256(r[3], r[7], t3, r[3]); \
 	\
 	/* \
 	 * t2 = krl; \
@@ -591,16 +759,8 @@
 	vpand256(r[2], t2, t2); \
 	vpand256(r[3], t3, t3); \
 	\
-	rol32_1_16(t3, t2, t1, t0, tt1, tt2, tt3, tt0); \
-	\
-	vpxor256(r[4], t0, t0); \
-	vpxor256(r[5], t1, t1); \
-	vpxor256(r[6], t2, t2); \
-	vpxor256(r[7], t3, t3); \
-	vmovdqa256(t0, r[4]); \
-	vmovdqa256(t1, r[5]); \
-	vmovdqa256(t2, r[6]); \
-	vmovdqa256(t3, r[7]); \
+	rol32_1_xor_16(t3, t2, t1, t0, r[7], r[6], r[5], r[4], tt1, tt2, tt3, \
+		       tt0); \
 	\
 	/* \
 	 * t0 = klr; \
@@ -614,18 +774,13 @@
 	vpshufb256(bcast[2], t0, t1); \
 	vpshufb256(bcast[3], t0, t0); \
 	\
-	vpor256(l4, t0, t0); \
-	vpor256(l5, t1, t1); \
-	vpor256(l6, t2, t2); \
-	vpor256(l7, t3, t3); \
-	\
-	vpxor256(l0, t0, l0); \
+	vpxor_or256(l0, l4, t0, l0); \
 	vmovdqa256(l0, l[0]); \
-	vpxor256(l1, t1, l1); \
+	vpxor_or256(l1, l5, t1, l1); \
 	vmovdqa256(l1, l[1]); \
-	vpxor256(l2, t2, l2); \
+	vpxor_or256(l2, l6, t2, l2); \
 	vmovdqa256(l2, l[2]); \
-	vpxor256(l3, t3, l3); \
+	vpxor_or256(l3, l7, t3, l3); \
 	vmovdqa256(l3, l[3]);
 
 #define byteslice_16x16b_fast(a0, b0, c0, d0, a1, b1, c1, d1, a2, b2, c2, d2, \
@@ -700,6 +855,221 @@
 	vpxor256_memld((rio) + 14 * 32, x0, x1); \
 	vpxor256_memld((rio) + 15 * 32, x0, x0);
 
+/* load N first blocks to registers and apply pre-whitening, blocks past N
+ * are set to whitening key; NVEC holds N in each 64-bit element */
+#define inpack16_pre_n(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+		       y5, y6, y7, rio, key, nvec) \
+	vmovq128_si256((key), x0); \
+	vpshufb256(pack_bswap, x0, x0); \
+	\
+	vpxor256_memld_blk2(rio, 0, nvec, x0, y7); \
+	vpxor256_memld_blk2(rio, 1, nvec, x0, y6); \
+	vpxor256_memld_blk2(rio, 2, nvec, x0, y5); \
+	vpxor256_memld_blk2(rio, 3, nvec, x0, y4); \
+	vpxor256_memld_blk2(rio, 4, nvec, x0, y3); \
+	vpxor256_memld_blk2(rio, 5, nvec, x0, y2); \
+	vpxor256_memld_blk2(rio, 6, nvec, x0, y1); \
+	vpxor256_memld_blk2(rio, 7, nvec, x0, y0); \
+	vpxor256_memld_blk2(rio, 8, nvec, x0, x7); \
+	vpxor256_memld_blk2(rio, 9, nvec, x0, x6); \
+	vpxor256_memld_blk2(rio, 10, nvec, x0, x5); \
+	vpxor256_memld_blk2(rio, 11, nvec, x0, x4); \
+	vpxor256_memld_blk2(rio, 12, nvec, x0, x3); \
+	vpxor256_memld_blk2(rio, 13, nvec, x0, x2); \
+	vpxor256_memld_blk2(rio, 14, nvec, x0, x1); \
+	vpxor256_memld_blk2(rio, 15, nvec, x0, x0);
+
+/* load IV and 31 first blocks from memory as CFB stream of previous
+ * ciphertext blocks and apply pre-whitening */
+#define inpack16_cfb_pre(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			 y5, y6, y7, rio, iv, key) \
+	vmovq128_si256((key), x0); \
+	vpshufb256(pack_bswap, x0, x0); \
+	\
+	vinserti128_memld((iv), (rio), y7); \
+	vpxor256(x0, y7, y7); \
+	vpxor256_memld((rio) + 1 * 32 - 16, x0, y6); \
+	vpxor256_memld((rio) + 2 * 32 - 16, x0, y5); \
+	vpxor256_memld((rio) + 3 * 32 - 16, x0, y4); \
+	vpxor256_memld((rio) + 4 * 32 - 16, x0, y3); \
+	vpxor256_memld((rio) + 5 * 32 - 16, x0, y2); \
+	vpxor256_memld((rio) + 6 * 32 - 16, x0, y1); \
+	vpxor256_memld((rio) + 7 * 32 - 16, x0, y0); \
+	vpxor256_memld((rio) + 8 * 32 - 16, x0, x7); \
+	vpxor256_memld((rio) + 9 * 32 - 16, x0, x6); \
+	vpxor256_memld((rio) + 10 * 32 - 16, x0, x5); \
+	vpxor256_memld((rio) + 11 * 32 - 16, x0, x4); \
+	vpxor256_memld((rio) + 12 * 32 - 16, x0, x3); \
+	vpxor256_memld((rio) + 13 * 32 - 16, x0, x2); \
+	vpxor256_memld((rio) + 14 * 32 - 16, x0, x1); \
+	vpxor256_memld((rio) + 15 * 32 - 16, x0, x0);
+
+/* multiply XTS tweaks by x in GF(2^128), little-endian block order */
+#define gf128mul_x_le(iv, mask, tmp) \
+	vpsrad256(31, iv, tmp); \
+	vpaddq256(iv, iv, iv); \
+	vpshufd256_0x1b(tmp, tmp); \
+	vpand256(mask, tmp, tmp); \
+	vpxor256(tmp, iv, iv);
+
+/* multiply XTS tweaks by x^2 in GF(2^128), little-endian block order */
+#define gf128mul_x2_le(iv, mask1, mask2, tmp0, tmp1) \
+	vpsrad256(31, iv, tmp0); \
+	vpaddq256(iv, iv, tmp1); \
+	vpsllq256(2, iv, iv); \
+	vpshufd256_0x1b(tmp0, tmp0); \
+	vpsrad256(31, tmp1, tmp1); \
+	vpand256(mask2, tmp0, tmp0); \
+	vpshufd256_0x1b(tmp1, tmp1); \
+	vpxor256(tmp0, iv, iv); \
+	vpand256(mask1, tmp1, tmp1); \
+	vpxor256(tmp1, iv, iv);
+
+#define xts_pre_blk(i, x, rio, tweaks, key, tw, mask1, mask2, tmp0, tmp1) \
+	vmovdqa256(tw, tweaks[i]); \
+	vpxor256_memld((rio) + (i) * 32, tw, x); \
+	vpxor256(key, x, x); \
+	gf128mul_x2_le(tw, mask1, mask2, tmp0, tmp1);
+
+/* load 32 blocks from memory, XOR with successive XTS tweaks starting from
+ * TWEAK and apply pre-whitening, tweaks are stored to TWEAKS for output
+ * whitening and TWEAK is updated to next unused tweak */
+#define inpack16_xts_pre(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			 y5, y6, y7, rio, tweak, tweaks, key, t0, t1, t2, t3, \
+			 t4) \
+	vmovq128_si256((key), t0); \
+	vpshufb256(pack_bswap, t0, t0); \
+	vmovdqa256_memld(&xts_gfmul_and_mask, t2); \
+	vmovdqa256_memld(&xts_gfmul_and_mask2, t3); \
+	\
+	/* first two tweaks, T and T*x, to low and high lanes */ \
+	vbroadcasti128_memld(tweak, t1); \
+	vmovdqa256(t1, t4); \
+	gf128mul_x_le(t4, t2, x0); \
+	vpblendd256_0xf0(t4, t1, t1); \
+	\
+	xts_pre_blk(0, y7, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(1, y6, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(2, y5, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(3, y4, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(4, y3, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(5, y2, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(6, y1, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(7, y0, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(8, x7, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(9, x6, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(10, x5, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(11, x4, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(12, x3, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(13, x2, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	xts_pre_blk(14, x1, rio, tweaks, t0, t1, t2, t3, t4, x0); \
+	vmovdqa256(t1, tweaks[15]); \
+	vpxor256_memld((rio) + 15 * 32, t1, x0); \
+	vpxor256(t0, x0, x0); \
+	gf128mul_x2_le(t1, t2, t3, t4, t0); \
+	\
+	vmovdqu256_lo128_memst(t1, tweak);
+
+#define ocb_pre_blk(i, x, rio, Ls, offs, key, offset) \
+	vpxor256_memld((Ls) + (i) * 32, offset, offs[i]); \
+	vpxor256_memld((rio) + (i) * 32, offs[i], x); \
+	vpxor256(key, x, x);
+
+/* load 32 blocks from memory, XOR with OCB offsets and apply pre-whitening.
+ * Offset of block i is OFFSET XOR LS[i], so all offsets are computed in
+ * parallel. Offsets are stored to OFFS for output whitening and OFFSET is
+ * updated to offset of last block */
+#define inpack16_ocb_pre(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			 y5, y6, y7, rio, offset, Ls, offs, key, t0, t1) \
+	vmovq128_si256((key), t0); \
+	vpshufb256(pack_bswap, t0, t0); \
+	vbroadcasti128_memld(offset, t1); \
+	\
+	ocb_pre_blk(0, y7, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(1, y6, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(2, y5, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(3, y4, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(4, y3, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(5, y2, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(6, y1, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(7, y0, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(8, x7, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(9, x6, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(10, x5, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(11, x4, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(12, x3, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(13, x2, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(14, x1, rio, Ls, offs, t0, t1); \
+	ocb_pre_blk(15, x0, rio, Ls, offs, t0, t1); \
+	\
+	vmovdqu256_hi128_memst(offs[15], offset);
+
+/* XOR 32 blocks from memory to OCB checksum */
+#define ocb_checksum_input16(rio, checksum, t0, t1, t128) \
+	vmovdqu256_memld((rio) + 0 * 32, t0); \
+	vmovdqu256_memld((rio) + 1 * 32, t1); \
+	vpxor256_memld((rio) + 2 * 32, t0, t0); \
+	vpxor256_memld((rio) + 3 * 32, t1, t1); \
+	vpxor256_memld((rio) + 4 * 32, t0, t0); \
+	vpxor256_memld((rio) + 5 * 32, t1, t1); \
+	vpxor256_memld((rio) + 6 * 32, t0, t0); \
+	vpxor256_memld((rio) + 7 * 32, t1, t1); \
+	vpxor256_memld((rio) + 8 * 32, t0, t0); \
+	vpxor256_memld((rio) + 9 * 32, t1, t1); \
+	vpxor256_memld((rio) + 10 * 32, t0, t0); \
+	vpxor256_memld((rio) + 11 * 32, t1, t1); \
+	vpxor256_memld((rio) + 12 * 32, t0, t0); \
+	vpxor256_memld((rio) + 13 * 32, t1, t1); \
+	vpxor256_memld((rio) + 14 * 32, t0, t0); \
+	vpxor256_memld((rio) + 15 * 32, t1, t1); \
+	vpxor256(t1, t0, t0); \
+	vpxor256_fold128(t0, t128); \
+	vpxor128_memld(checksum, t128, t128); \
+	vmovdqu128_memst(t128, checksum);
+
+/* XOR 32 blocks in registers to OCB checksum */
+#define ocb_checksum16(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+		       y5, y6, y7, checksum, t0, t1, t128) \
+	vpxor256(x0, x1, t0); \
+	vpxor256(x2, x3, t1); \
+	vpxor256(x4, t0, t0); \
+	vpxor256(x5, t1, t1); \
+	vpxor256(x6, t0, t0); \
+	vpxor256(x7, t1, t1); \
+	vpxor256(y0, t0, t0); \
+	vpxor256(y1, t1, t1); \
+	vpxor256(y2, t0, t0); \
+	vpxor256(y3, t1, t1); \
+	vpxor256(y4, t0, t0); \
+	vpxor256(y5, t1, t1); \
+	vpxor256(y6, t0, t0); \
+	vpxor256(y7, t1, t1); \
+	vpxor256(t1, t0, t0); \
+	vpxor256_fold128(t0, t128); \
+	vpxor128_memld(checksum, t128, t128); \
+	vmovdqu128_memst(t128, checksum);
+
+/* XOR 32 blocks in registers with XTS tweaks, blocks are in write_output
+ * order */
+#define xor_tweaks16(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, y5, \
+		     y6, y7, tweaks) \
+	vpxor256(tweaks[0], x0, x0); \
+	vpxor256(tweaks[1], x1, x1); \
+	vpxor256(tweaks[2], x2, x2); \
+	vpxor256(tweaks[3], x3, x3); \
+	vpxor256(tweaks[4], x4, x4); \
+	vpxor256(tweaks[5], x5, x5); \
+	vpxor256(tweaks[6], x6, x6); \
+	vpxor256(tweaks[7], x7, x7); \
+	vpxor256(tweaks[8], y0, y0); \
+	vpxor256(tweaks[9], y1, y1); \
+	vpxor256(tweaks[10], y2, y2); \
+	vpxor256(tweaks[11], y3, y3); \
+	vpxor256(tweaks[12], y4, y4); \
+	vpxor256(tweaks[13], y5, y5); \
+	vpxor256(tweaks[14], y6, y6); \
+	vpxor256(tweaks[15], y7, y7);
+
 /* byteslice pre-whitened blocks and store to temporary memory */
 #define inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, y5, \
 		      y6, y7, mem_ab, mem_cd) \
@@ -770,6 +1140,247 @@
 	vmovdqu256_memst(y6, (rio) + 14 * 32); \
 	vmovdqu256_memst(y7, (rio) + 15 * 32);
 
+/* store N first blocks, blocks past N are not written; NVEC holds N in each
+ * 64-bit element */
+#define write_output_n(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+		       y5, y6, y7, rio, nvec) \
+	vmovdqu256_memst_blk2(x0, rio, 0, nvec); \
+	vmovdqu256_memst_blk2(x1, rio, 1, nvec); \
+	vmovdqu256_memst_blk2(x2, rio, 2, nvec); \
+	vmovdqu256_memst_blk2(x3, rio, 3, nvec); \
+	vmovdqu256_memst_blk2(x4, rio, 4, nvec); \
+	vmovdqu256_memst_blk2(x5, rio, 5, nvec); \
+	vmovdqu256_memst_blk2(x6, rio, 6, nvec); \
+	vmovdqu256_memst_blk2(x7, rio, 7, nvec); \
+	vmovdqu256_memst_blk2(y0, rio, 8, nvec); \
+	vmovdqu256_memst_blk2(y1, rio, 9, nvec); \
+	vmovdqu256_memst_blk2(y2, rio, 10, nvec); \
+	vmovdqu256_memst_blk2(y3, rio, 11, nvec); \
+	vmovdqu256_memst_blk2(y4, rio, 12, nvec); \
+	vmovdqu256_memst_blk2(y5, rio, 13, nvec); \
+	vmovdqu256_memst_blk2(y6, rio, 14, nvec); \
+	vmovdqu256_memst_blk2(y7, rio, 15, nvec);
+
+/* XOR 32 blocks from memory to registers, blocks are in write_output order */
+#define xor_input16(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, y5, \
+		    y6, y7, rio) \
+	vpxor256_memld((rio) + 0 * 32, x0, x0); \
+	vpxor256_memld((rio) + 1 * 32, x1, x1); \
+	vpxor256_memld((rio) + 2 * 32, x2, x2); \
+	vpxor256_memld((rio) + 3 * 32, x3, x3); \
+	vpxor256_memld((rio) + 4 * 32, x4, x4); \
+	vpxor256_memld((rio) + 5 * 32, x5, x5); \
+	vpxor256_memld((rio) + 6 * 32, x6, x6); \
+	vpxor256_memld((rio) + 7 * 32, x7, x7); \
+	vpxor256_memld((rio) + 8 * 32, y0, y0); \
+	vpxor256_memld((rio) + 9 * 32, y1, y1); \
+	vpxor256_memld((rio) + 10 * 32, y2, y2); \
+	vpxor256_memld((rio) + 11 * 32, y3, y3); \
+	vpxor256_memld((rio) + 12 * 32, y4, y4); \
+	vpxor256_memld((rio) + 13 * 32, y5, y5); \
+	vpxor256_memld((rio) + 14 * 32, y6, y6); \
+	vpxor256_memld((rio) + 15 * 32, y7, y7);
+
+/* XOR 32 blocks in registers with CBC chaining values, IV for first block and
+ * previous input block from memory for rest, blocks are in write_output order */
+#define xor_cbc_input16(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			y5, y6, y7, rio, iv, t0) \
+	vinserti128_memld((iv), (rio), t0); \
+	vpxor256(t0, x0, x0); \
+	vpxor256_memld((rio) + 1 * 32 - 16, x1, x1); \
+	vpxor256_memld((rio) + 2 * 32 - 16, x2, x2); \
+	vpxor256_memld((rio) + 3 * 32 - 16, x3, x3); \
+	vpxor256_memld((rio) + 4 * 32 - 16, x4, x4); \
+	vpxor256_memld((rio) + 5 * 32 - 16, x5, x5); \
+	vpxor256_memld((rio) + 6 * 32 - 16, x6, x6); \
+	vpxor256_memld((rio) + 7 * 32 - 16, x7, x7); \
+	vpxor256_memld((rio) + 8 * 32 - 16, y0, y0); \
+	vpxor256_memld((rio) + 9 * 32 - 16, y1, y1); \
+	vpxor256_memld((rio) + 10 * 32 - 16, y2, y2); \
+	vpxor256_memld((rio) + 11 * 32 - 16, y3, y3); \
+	vpxor256_memld((rio) + 12 * 32 - 16, y4, y4); \
+	vpxor256_memld((rio) + 13 * 32 - 16, y5, y5); \
+	vpxor256_memld((rio) + 14 * 32 - 16, y6, y6); \
+	vpxor256_memld((rio) + 15 * 32 - 16, y7, y7);
+
+/* generate 32 big-endian counter blocks to registers and apply
+ * pre-whitening, lowest counter byte must not overflow */
+#define inpack16_ctr_pre(x0, x1, x2, x3, x4, x5, x6, x7, y0, y1, y2, y3, y4, \
+			 y5, y6, y7, iv, key, t0, t1) \
+	vbroadcasti128_memld(iv, t0); \
+	vmovdqa256_memld(&bige_addb_0_1, t1); \
+	vpaddb256(t1, t0, y7); \
+	vmovdqa256_memld(&bige_addb_2_3, t1); \
+	vpaddb256(t1, t0, y6); \
+	vmovdqa256_memld(&bige_addb_4, t1); \
+	vpaddb256(t1, y7, y5); \
+	vpaddb256(t1, y6, y4); \
+	vpaddb256(t1, y5, y3); \
+	vpaddb256(t1, y4, y2); \
+	vpaddb256(t1, y3, y1); \
+	vpaddb256(t1, y2, y0); \
+	vpaddb256(t1, y1, x7); \
+	vpaddb256(t1, y0, x6); \
+	vpaddb256(t1, x7, x5); \
+	vpaddb256(t1, x6, x4); \
+	vpaddb256(t1, x5, x3); \
+	vpaddb256(t1, x4, x2); \
+	vpaddb256(t1, x3, x1); \
+	vpaddb256(t1, x2, x0); \
+	\
+	vmovq128_si256((key), t0); \
+	vpshufb256(pack_bswap, t0, t0); \
+	\
+	vpxor256(t0, y7, y7); \
+	vpxor256(t0, y6, y6); \
+	vpxor256(t0, y5, y5); \
+	vpxor256(t0, y4, y4); \
+	vpxor256(t0, y3, y3); \
+	vpxor256(t0, y2, y2); \
+	vpxor256(t0, y1, y1); \
+	vpxor256(t0, y0, y0); \
+	vpxor256(t0, x7, x7); \
+	vpxor256(t0, x6, x6); \
+	vpxor256(t0, x5, x5); \
+	vpxor256(t0, x4, x4); \
+	vpxor256(t0, x3, x3); \
+	vpxor256(t0, x2, x2); \
+	vpxor256(t0, x1, x1); \
+	vpxor256(t0, x0, x0);
+
+/*
+ * IN:
+ *  x0..x15: 32 pre-whitened input blocks from inpack16_pre
+ * OUT:
+ *  x0..x15: 32 encrypted blocks, in write_output order:
+ *           7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+ */
+#define enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		  x13, x14, x15, ab, cd, tmp0, tmp1, k, lastk) \
+	inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		      x13, x14, x15, ab, cd); \
+	\
+	k = 0; \
+	while (1) { \
+	  enc_rounds16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		       x13, x14, x15, ab, cd, k); \
+	  \
+	  if (k == lastk - 8) \
+	    break; \
+	  \
+	  fls16(ab, x0, x1, x2, x3, x4, x5, x6, x7, cd, x8, x9, x10, x11, x12, \
+		x13, x14, x15, &ctx->key_table[k + 8], &ctx->key_table[k + 9]); \
+	  \
+	  k += 8; \
+	} \
+	\
+	/* load CD for output */ \
+	vmovdqa256(cd[0], x8); \
+	vmovdqa256(cd[1], x9); \
+	vmovdqa256(cd[2], x10); \
+	vmovdqa256(cd[3], x11); \
+	vmovdqa256(cd[4], x12); \
+	vmovdqa256(cd[5], x13); \
+	vmovdqa256(cd[6], x14); \
+	vmovdqa256(cd[7], x15); \
+	\
+	outunpack16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, \
+		    x14, x15, ctx->key_table[lastk], tmp0, tmp1);
+
+/*
+ * IN:
+ *  x0..x15: 32 pre-whitened input blocks from inpack16_pre
+ * OUT:
+ *  x0..x15: 32 decrypted blocks, in write_output order:
+ *           7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+ */
+#define dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		  x13, x14, x15, ab, cd, tmp0, tmp1, k, firstk) \
+	inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		      x13, x14, x15, ab, cd); \
+	\
+	k = firstk - 8; \
+	while (1) { \
+	  dec_rounds16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, \
+		       x13, x14, x15, ab, cd, k); \
+	  \
+	  if (k == 0) \
+	    break; \
+	  \
+	  fls16(ab, x0, x1, x2, x3, x4, x5, x6, x7, cd, x8, x9, x10, x11, x12, \
+		x13, x14, x15, &ctx->key_table[k + 1], &ctx->key_table[k]); \
+	  \
+	  k -= 8; \
+	} \
+	\
+	/* load CD for output */ \
+	vmovdqa256(cd[0], x8); \
+	vmovdqa256(cd[1], x9); \
+	vmovdqa256(cd[2], x10); \
+	vmovdqa256(cd[3], x11); \
+	vmovdqa256(cd[4], x12); \
+	vmovdqa256(cd[5], x13); \
+	vmovdqa256(cd[6], x14); \
+	vmovdqa256(cd[7], x15); \
+	\
+	outunpack16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, \
+		    x14, x15, ctx->key_table[0], tmp0, tmp1);
+
+/**********************************************************************
+  GHASH macros
+ **********************************************************************/
+/* multiply two byte-reversed blocks in X with two byte-reversed hash key
+ * powers in H and accumulate unreduced 256-bit products to LO, MID and HI */
+#define ghash_mul_acc256(x, h, lo, mid, hi, t0) \
+	vpclmulqdq256(0x00, h, x, t0); \
+	vpxor256(t0, lo, lo); \
+	vpclmulqdq256(0x11, h, x, t0); \
+	vpxor256(t0, hi, hi); \
+	vpclmulqdq256(0x01, h, x, t0); \
+	vpxor256(t0, mid, mid); \
+	vpclmulqdq256(0x10, h, x, t0); \
+	vpxor256(t0, mid, mid);
+
+/* reduce unreduced product LO, MID and HI of byte-reversed operands modulo
+ * GCM polynomial to O, clobbers LO and HI */
+#define ghash_reduce(lo, mid, hi, o, t0, t1, t2) \
+	vpslldq128(8, mid, t0); \
+	vpsrldq128(8, mid, t1); \
+	vpxor128(t0, lo, lo); \
+	vpxor128(t1, hi, hi); \
+	\
+	/* shift product left by one bit, operands are bit-reflected */ \
+	vpsrld128(31, lo, t0); \
+	vpsrld128(31, hi, t1); \
+	vpslld128(1, lo, lo); \
+	vpslld128(1, hi, hi); \
+	vpsrldq128(12, t0, t2); \
+	vpslldq128(4, t1, t1); \
+	vpslldq128(4, t0, t0); \
+	vpor128(t0, lo, lo); \
+	vpor128(t1, hi, hi); \
+	vpor128(t2, hi, hi); \
+	\
+	/* first phase of reduction */ \
+	vpslld128(31, lo, t0); \
+	vpslld128(30, lo, t1); \
+	vpslld128(25, lo, t2); \
+	vpxor128(t1, t0, t0); \
+	vpxor128(t2, t0, t0); \
+	vpsrldq128(4, t0, t1); \
+	vpslldq128(12, t0, t0); \
+	vpxor128(t0, lo, lo); \
+	\
+	/* second phase of reduction */ \
+	vpsrld128(1, lo, t2); \
+	vpsrld128(2, lo, t0); \
+	vpxor128(t0, t2, t2); \
+	vpsrld128(7, lo, t0); \
+	vpxor128(t0, t2, t2); \
+	vpxor128(t1, t2, t2); \
+	vpxor128(t2, lo, lo); \
+	vpxor128(lo, hi, o);
+
 /**********************************************************************
   macros for defining constant vectors
  **********************************************************************/
@@ -850,6 +1461,31 @@ static const __m256i bcast[8] =
   M256I_REP32(4), M256I_REP32(5), M256I_REP32(6), M256I_REP32(7)
 };
 
+/* For CTR-mode, byte additions to lowest byte of big-endian counter */
+static const __m256i bige_addb_0_1 =
+  M256I_BYTE(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1);
+
+static const __m256i bige_addb_2_3 =
+  M256I_BYTE(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2,
+	     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3);
+
+static const __m256i bige_addb_4 =
+  M256I_BYTE(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4,
+	     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4);
+
+/* For XTS-mode, reduction constants for tweak multiplication by x and x^2 */
+static const __m256i xts_gfmul_and_mask =
+  M256I_U32(0x87, 0, 1, 0, 0x87, 0, 1, 0);
+
+static const __m256i xts_gfmul_and_mask2 =
+  M256I_U32(0x10e, 0, 2, 0, 0x10e, 0, 2, 0);
+
+/* For GHASH, byte-reversal of 128-bit lanes */
+static const __m256i bswap128_mask =
+  M256I_BYTE(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+	     15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
 #ifdef USE_GFNI
 
 /* Pre-filters and post-filters bit-matrixes for Camellia sboxes s1, s2, s3
@@ -916,6 +1552,17 @@ static const uint64_t post_filter_bitmatrix_s3 =
 		    BV8(0, 0, 0, 1, 1, 1, 0, 0),
 		    BV8(0, 0, 0, 0, 0, 0, 0, 1));
 
+/* Bit-matrix for shifting bytes right by 7, for rol32_1_xor_16: */
+static const uint64_t shr7_bitmatrix =
+	      BM8X8(BV8(0, 0, 0, 0, 0, 0, 0, 1),
+		    BV8(0, 0, 0, 0, 0, 0, 0, 0),
+		    BV8(0, 0, 0, 0, 0, 0, 0, 0),
+		    BV8(0, 0, 0, 0, 0, 0, 0, 0),
+		    BV8(0, 0, 0, 0, 0, 0, 0, 0),
+		    BV8(0, 0, 0, 0, 0, 0, 0, 0),
+		    BV8(0, 0, 0, 0, 0, 0, 0, 0),
+		    BV8(0, 0, 0, 0, 0, 0, 0, 0));
+
 #else /* USE_GFNI */
 
 /*
@@ -1068,6 +1715,24 @@ static const __m256i mask_0f =
 
 #endif /* USE_GFNI */
 
+/* Generates NBLKS big-endian counter blocks from CTR to DST and increments
+ * CTR by NBLKS. */
+static void ctr_gen_blks(uint8_t *dst, uint8_t *ctr, unsigned int nblks)
+{
+  unsigned int i, j;
+
+  for (i = 0; i < nblks; i++) {
+    for (j = 0; j < 16; j++)
+      dst[i * 16 + j] = ctr[j];
+
+    /* increment big-endian counter */
+    for (j = 16; j > 0; j--) {
+      if (++ctr[j - 1] != 0)
+	break;
+    }
+  }
+}
+
 /* Encrypts 32 input block from IN and writes result to OUT. IN and OUT may
  * unaligned pointers. */
 void camellia_encrypt_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
@@ -1080,6 +1745,9 @@ void camellia_encrypt_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
   __m256i cd[8];
   __m256i tmp0, tmp1;
   unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
 
   if (ctx->key_length > 16)
     lastk = 32;
@@ -1089,44 +1757,119 @@ void camellia_encrypt_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
   inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
 	       x15, in, ctx->key_table[0]);
 
-  inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-		x15, ab, cd);
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
 
-  k = 0;
-  while (1) {
-    enc_rounds16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-		 x15, ab, cd, k);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
 
-    if (k == lastk - 8)
-      break;
+/* Decrypts 32 input block from IN and writes result to OUT. IN and OUT may
+ * unaligned pointers. */
+void camellia_decrypt_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i tmp0, tmp1;
+  unsigned int firstk, k;
+  frequent_constants_declare;
 
-    fls16(ab, x0, x1, x2, x3, x4, x5, x6, x7, cd, x8, x9, x10, x11, x12, x13,
-	  x14, x15, &ctx->key_table[k + 8], &ctx->key_table[k + 9]);
+  prepare_frequent_constants();
 
-    k += 8;
-  }
+  if (ctx->key_length > 16)
+    firstk = 32;
+  else
+    firstk = 24;
 
-  /* load CD for output */
-  vmovdqa256(cd[0], x8);
-  vmovdqa256(cd[1], x9);
-  vmovdqa256(cd[2], x10);
-  vmovdqa256(cd[3], x11);
-  vmovdqa256(cd[4], x12);
-  vmovdqa256(cd[5], x13);
-  vmovdqa256(cd[6], x14);
-  vmovdqa256(cd[7], x15);
+  inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	       x15, in, ctx->key_table[firstk]);
 
-  outunpack16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-	      x15, ctx->key_table[lastk], tmp0, tmp1);
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
 
   write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
 	       x8, out);
 }
 
-/* Decrypts 32 input block from IN and writes result to OUT. IN and OUT may
- * unaligned pointers. */
-void camellia_decrypt_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
-				     const void *vin)
+/* Encrypts NBLKS (1 to 32) input blocks from IN and writes result to OUT.
+ * Blocks past NBLKS are not read or written. IN and OUT may unaligned
+ * pointers. */
+void camellia_encrypt_nblks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				    const void *vin, unsigned int nblks)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i tmp0, tmp1;
+  __m256i nvec;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  vpbroadcastq(nblks, nvec);
+
+  inpack16_pre_n(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		 x14, x15, in, ctx->key_table[0], nvec);
+
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  write_output_n(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+		 x9, x8, out, nvec);
+}
+
+/* Decrypts NBLKS (1 to 32) input blocks from IN and writes result to OUT.
+ * Blocks past NBLKS are not read or written. IN and OUT may unaligned
+ * pointers. */
+void camellia_decrypt_nblks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				    const void *vin, unsigned int nblks)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i tmp0, tmp1;
+  __m256i nvec;
+  unsigned int firstk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    firstk = 32;
+  else
+    firstk = 24;
+
+  vpbroadcastq(nblks, nvec);
+
+  inpack16_pre_n(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		 x14, x15, in, ctx->key_table[firstk], nvec);
+
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
+
+  write_output_n(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+		 x9, x8, out, nvec);
+}
+
+/* Decrypts 32 input blocks from IN in CBC mode and writes result to OUT. IV
+ * is XORed to first decrypted block and is replaced with last input block.
+ * IN and OUT may unaligned pointers and may point to same buffer. */
+void camellia_cbc_dec_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *iv)
 {
   char *out = vout;
   const char *in = vin;
@@ -1134,7 +1877,11 @@ void camellia_decrypt_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
   __m256i ab[8];
   __m256i cd[8];
   __m256i tmp0, tmp1;
+  __m128i last;
   unsigned int firstk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
 
   if (ctx->key_length > 16)
     firstk = 32;
@@ -1144,36 +1891,410 @@ void camellia_decrypt_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
   inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
 	       x15, in, ctx->key_table[firstk]);
 
-  inpack16_post(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-		x15, ab, cd);
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
 
-  k = firstk - 8;
-  while (1) {
-    dec_rounds16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
-		 x14, x15, ab, cd, k);
+  /* Load chaining values before output overwrites input in-place. */
+  vmovdqu128_memld(in + 31 * 16, last);
+  xor_cbc_input16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+		  x9, x8, in, iv, tmp0);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+  vmovdqu128_memst(last, iv);
+}
 
-    if (k == 0)
-      break;
+/* Decrypts 32 input blocks from IN in CFB mode and writes result to OUT.
+ * IV and 31 first input blocks are encrypted and XORed with input blocks. IV
+ * is replaced with last input block. IN and OUT may unaligned pointers and
+ * may point to same buffer. */
+void camellia_cfb_dec_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *iv)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i tmp0, tmp1;
+  __m128i last;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  inpack16_cfb_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, iv, ctx->key_table[0]);
+
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  /* Load next IV before output overwrites input in-place. */
+  vmovdqu128_memld(in + 31 * 16, last);
+  xor_input16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	      x8, in);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+  vmovdqu128_memst(last, iv);
+}
+
+/* Encrypts 32 input blocks from IN in XTS mode and writes result to OUT.
+ * TWEAK is encrypted tweak for first block and is updated to tweak for next
+ * block. IN and OUT may unaligned pointers and may point to same buffer. */
+void camellia_xts_enc_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *tweak)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i tweaks[16];
+  __m256i tmp0, tmp1, tmp2, tmp3, tmp4;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  inpack16_xts_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, tweak, tweaks, ctx->key_table[0], tmp0, tmp1,
+		   tmp2, tmp3, tmp4);
+
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  xor_tweaks16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+	       x9, x8, tweaks);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
+
+/* Decrypts 32 input blocks from IN in XTS mode and writes result to OUT.
+ * TWEAK is encrypted tweak for first block and is updated to tweak for next
+ * block. IN and OUT may unaligned pointers and may point to same buffer. */
+void camellia_xts_dec_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *tweak)
+{
+  char *out = vout;
+  const char *in = vin;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i tweaks[16];
+  __m256i tmp0, tmp1, tmp2, tmp3, tmp4;
+  unsigned int firstk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    firstk = 32;
+  else
+    firstk = 24;
+
+  inpack16_xts_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, tweak, tweaks, ctx->key_table[firstk], tmp0,
+		   tmp1, tmp2, tmp3, tmp4);
+
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
+
+  xor_tweaks16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+	       x9, x8, tweaks);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
+
+/* Encrypts 32 input blocks from IN in OCB mode and writes result to OUT.
+ * OFFSET is offset of previous block and LS is array of 32 offset deltas, so
+ * that offset of block i is OFFSET XOR LS[i]. OFFSET is updated to offset of
+ * last block and input blocks are XORed to CHECKSUM. IN and OUT may
+ * unaligned pointers and may point to same buffer. */
+void camellia_ocb_enc_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *offset,
+				     void *checksum, const void *vLs)
+{
+  char *out = vout;
+  const char *in = vin;
+  const char *Ls = vLs;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i offs[16];
+  __m256i tmp0, tmp1;
+  __m128i ck;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  ocb_checksum_input16(in, checksum, tmp0, tmp1, ck);
+  inpack16_ocb_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, offset, Ls, offs, ctx->key_table[0], tmp0,
+		   tmp1);
+
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  xor_tweaks16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+	       x9, x8, offs);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
+
+/* Decrypts 32 input blocks from IN in OCB mode and writes result to OUT.
+ * OFFSET and LS are as for camellia_ocb_enc_32blks_simd256. OFFSET is updated
+ * to offset of last block and output blocks are XORed to CHECKSUM. IN and OUT
+ * may unaligned pointers and may point to same buffer. */
+void camellia_ocb_dec_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *offset,
+				     void *checksum, const void *vLs)
+{
+  char *out = vout;
+  const char *in = vin;
+  const char *Ls = vLs;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i offs[16];
+  __m256i tmp0, tmp1;
+  __m128i ck;
+  unsigned int firstk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    firstk = 32;
+  else
+    firstk = 24;
+
+  inpack16_ocb_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		   x14, x15, in, offset, Ls, offs, ctx->key_table[firstk], tmp0,
+		   tmp1);
+
+  dec_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, firstk);
+
+  xor_tweaks16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+	       x9, x8, offs);
+  ocb_checksum16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10,
+		 x9, x8, checksum, tmp0, tmp1, ck);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
+
+/* Encrypts 32 big-endian counter blocks starting from IV, XORs result with
+ * 32 input blocks from IN and writes result to OUT. IV is incremented by 32.
+ * IN and OUT may unaligned pointers. */
+void camellia_ctr_enc_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				     const void *vin, void *viv)
+{
+  char *out = vout;
+  const char *in = vin;
+  uint8_t *iv = viv;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i tmp0, tmp1;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  if (iv[15] <= 0xff - 32) {
+    /* Counter additions do not overflow the lowest byte, generate counter
+     * blocks with byte additions in registers. */
+    inpack16_ctr_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12,
+		     x13, x14, x15, iv, ctx->key_table[0], tmp0, tmp1);
+    iv[15] += 32;
+  } else {
+    /* Handle carry propagation through whole 128-bit counter. */
+    uint8_t ctrblks[32 * 16];
+
+    ctr_gen_blks(ctrblks, iv, 32);
+    inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		 x14, x15, ctrblks, ctx->key_table[0]);
+  }
+
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
+
+  xor_input16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	      x8, in);
+  write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	       x8, out);
+}
+
+/* GHASH of 16 blocks from IN with single reduction, two blocks per 256-bit
+ * vector. HASH is byte-reversed hash state and HTABLE is table of
+ * byte-reversed hash key powers H^16, ..., H^1. If REFLECT is zero, input
+ * blocks are not byte-reflected, which gives POLYVAL instead (RFC 8452,
+ * Appendix A). */
+static inline __m128i ghash_blks16(__m128i hash, const char *in,
+				   const char *Htable, int reflect)
+{
+  __m256i lo, mid, hi, x, h, bswap, t0;
+  __m128i lo128, mid128, hi128, t1, t2, t3;
+  unsigned int i;
+
+  vmovdqa256_memld(&bswap128_mask, bswap);
+
+  vmovdqu256_memld(in, x);
+  if (reflect)
+    vpshufb256(bswap, x, x);
+  vpxor256(_mm256_zextsi128_si256(hash), x, x);
+  vmovdqu256_memld(Htable, h);
+  vpclmulqdq256(0x00, h, x, lo);
+  vpclmulqdq256(0x11, h, x, hi);
+  vpclmulqdq256(0x01, h, x, mid);
+  vpclmulqdq256(0x10, h, x, t0);
+  vpxor256(t0, mid, mid);
+
+  for (i = 1; i < 8; i++) {
+    vmovdqu256_memld(in + i * 32, x);
+    if (reflect)
+      vpshufb256(bswap, x, x);
+    vmovdqu256_memld(Htable + i * 32, h);
+    ghash_mul_acc256(x, h, lo, mid, hi, t0);
+  }
+
+  vpxor256_fold128(lo, lo128);
+  vpxor256_fold128(mid, mid128);
+  vpxor256_fold128(hi, hi128);
+  ghash_reduce(lo128, mid128, hi128, hash, t1, t2, t3);
+  return hash;
+}
+
+/* Updates GHASH state HASH with NBLKS blocks from IN. HTABLE is table of
+ * byte-reversed hash key powers H^16, ..., H^1. Blocks are processed 16 at a
+ * time with single reduction per 16 blocks, remaining blocks are processed
+ * with SIMD128 implementation. */
+void camellia_ghash_simd256(void *vhash, const void *Htable, const void *vin,
+			    size_t nblks)
+{
+  const char *in = vin;
+  __m128i hash, bswap;
+
+  if (nblks >= 16) {
+    bswap = _mm256_castsi256_si128(bswap128_mask);
+    vmovdqu128_memld(vhash, hash);
+    vpshufb128(bswap, hash, hash);
+
+    while (nblks >= 16) {
+      hash = ghash_blks16(hash, in, Htable, 1);
+      in += 16 * 16;
+      nblks -= 16;
+    }
+
+    vpshufb128(bswap, hash, hash);
+    vmovdqu128_memst(hash, vhash);
+  }
+
+  if (nblks)
+    camellia_ghash_simd128(vhash, Htable, in, nblks);
+}
+
+/* Updates POLYVAL state HASH with NBLKS blocks from IN, as
+ * camellia_polyval_simd128. Blocks are processed 16 at a time with single
+ * reduction per 16 blocks, remaining blocks are processed with SIMD128
+ * implementation. */
+void camellia_polyval_simd256(void *vhash, const void *Htable,
+			      const void *vin, size_t nblks)
+{
+  const char *in = vin;
+  __m128i hash;
+
+  if (nblks >= 16) {
+    vmovdqu128_memld(vhash, hash);
 
-    fls16(ab, x0, x1, x2, x3, x4, x5, x6, x7, cd, x8, x9, x10, x11, x12, x13,
-	  x14, x15, &ctx->key_table[k + 1], &ctx->key_table[k]);
+    while (nblks >= 16) {
+      hash = ghash_blks16(hash, in, Htable, 0);
+      in += 16 * 16;
+      nblks -= 16;
+    }
 
-    k -= 8;
+    vmovdqu128_memst(hash, vhash);
   }
 
-  /* load CD for output */
-  vmovdqa256(cd[0], x8);
-  vmovdqa256(cd[1], x9);
-  vmovdqa256(cd[2], x10);
-  vmovdqa256(cd[3], x11);
-  vmovdqa256(cd[4], x12);
-  vmovdqa256(cd[5], x13);
-  vmovdqa256(cd[6], x14);
-  vmovdqa256(cd[7], x15);
+  if (nblks)
+    camellia_polyval_simd128(vhash, Htable, in, nblks);
+}
+
+/* Encrypts 32 big-endian counter blocks starting from IV, XORs result with
+ * 32 input blocks from IN and writes result to OUT, as
+ * camellia_ctr_enc_32blks_simd256. GHASH state HASH is updated with 32 blocks
+ * from GHASH_IN, which are read before OUT is written. IN, OUT and GHASH_IN
+ * may unaligned pointers. */
+void camellia_gcm_32blks_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				 const void *vin, void *viv, void *vhash,
+				 const void *Htable, const void *vghash_in)
+{
+  char *out = vout;
+  const char *in = vin;
+  const char *ghash_in = vghash_in;
+  uint8_t *iv = viv;
+  __m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+  __m256i ab[8];
+  __m256i cd[8];
+  __m256i tmp0, tmp1;
+  __m128i hash, bswap;
+  unsigned int lastk, k;
+  frequent_constants_declare;
+
+  prepare_frequent_constants();
+
+  /* GHASH does not depend on cipher state, so carry-less multiplications
+   * can execute in parallel with counter generation and first rounds. */
+  bswap = _mm256_castsi256_si128(bswap128_mask);
+  vmovdqu128_memld(vhash, hash);
+  vpshufb128(bswap, hash, hash);
+  hash = ghash_blks16(hash, ghash_in, Htable, 1);
+  hash = ghash_blks16(hash, ghash_in + 16 * 16, Htable, 1);
+  vpshufb128(bswap, hash, hash);
+  vmovdqu128_memst(hash, vhash);
+
+  if (ctx->key_length > 16)
+    lastk = 32;
+  else
+    lastk = 24;
+
+  if (iv[15] <= 0xff - 32) {
+    inpack16_ctr_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12,
+		     x13, x14, x15, iv, ctx->key_table[0], tmp0, tmp1);
+    iv[15] += 32;
+  } else {
+    uint8_t ctrblks[32 * 16];
+
+    ctr_gen_blks(ctrblks, iv, 32);
+    inpack16_pre(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13,
+		 x14, x15, ctrblks, ctx->key_table[0]);
+  }
 
-  outunpack16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
-	      x15, ctx->key_table[0], tmp0, tmp1);
+  enc_blk16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14,
+	    x15, ab, cd, tmp0, tmp1, k, lastk);
 
+  xor_input16(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
+	      x8, in);
   write_output(x7, x6, x5, x4, x3, x2, x1, x0, x15, x14, x13, x12, x11, x10, x9,
 	       x8, out);
 }
@@ -0,0 +1,2270 @@
+/*
+ * Copyright (C) 2026 Jussi Kivilinna <jussi.kivilinna@iki.fi>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Block cipher modes of operation on top of the parallel SIMD128 and SIMD256
+ * implementations of Camellia. Full 16 block (SIMD128) and 32 block (SIMD256)
+ * batches are passed directly to the parallel implementations, partial
+ * batches at the end of input are handled with the partial batch
+ * implementations or with stack buffers.
+ *
+ * This file is portable C and is linked with any of the intrinsics or
+ * assembly implementations. Build with USE_SIMD256 to include the SIMD256
+ * variants.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "camellia_simd.h"
+
+/* Clear sensitive data from stack buffers. */
+static void wipe_memory(void *ptr, size_t len)
+{
+  volatile uint8_t *vptr = ptr;
+
+  while (len--)
+    *vptr++ = 0;
+}
+
+/* XORs 16 byte blocks A and B to DST. */
+static inline void xor_blk(uint8_t *dst, const uint8_t *a, const uint8_t *b)
+{
+  uint64_t x[2], y[2];
+
+  memcpy(x, a, 16);
+  memcpy(y, b, 16);
+  x[0] ^= y[0];
+  x[1] ^= y[1];
+  memcpy(dst, x, 16);
+}
+
+/* Multiplies XTS tweak T by x in GF(2^128), little-endian block order. */
+static void xts_mul_x(uint8_t *t)
+{
+  unsigned int carry = t[15] >> 7;
+  int i;
+
+  for (i = 15; i > 0; i--)
+    t[i] = (t[i] << 1) | (t[i - 1] >> 7);
+  t[0] = (t[0] << 1) ^ (0x87 & -carry);
+}
+
+/* Adds NBLKS to 16 byte big-endian counter CTR. */
+static void ctr_add(uint8_t *ctr, size_t nblks)
+{
+  unsigned int i;
+  unsigned int carry;
+
+  for (i = 16; i > 0 && nblks; i--) {
+    carry = ctr[i - 1] + (nblks & 0xff);
+    ctr[i - 1] = carry & 0xff;
+    nblks = (nblks >> 8) + (carry >> 8);
+  }
+}
+
+typedef void (*blks_crypt_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+				const void *in);
+
+typedef void (*nblks_crypt_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+				 const void *in, unsigned int nblks);
+
+/* Processes full batches of WIDTH blocks with CRYPT and final partial batch
+ * with partial batch implementation CRYPT_N. */
+static void ecb_crypt(struct camellia_simd_ctx *ctx, uint8_t *out,
+		      const uint8_t *in, size_t nblocks, unsigned int width,
+		      blks_crypt_fn_t crypt, nblks_crypt_fn_t crypt_n)
+{
+  while (nblocks >= width) {
+    crypt(ctx, out, in);
+    out += width * 16;
+    in += width * 16;
+    nblocks -= width;
+  }
+
+  if (nblocks)
+    crypt_n(ctx, out, in, nblocks);
+}
+
+void camellia_encrypt_blocks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks)
+{
+  ecb_crypt(ctx, out, in, nblocks, 16, camellia_encrypt_16blks_simd128,
+	    camellia_encrypt_nblks_simd128);
+}
+
+void camellia_decrypt_blocks_simd128(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks)
+{
+  ecb_crypt(ctx, out, in, nblocks, 16, camellia_decrypt_16blks_simd128,
+	    camellia_decrypt_nblks_simd128);
+}
+
+/* Processes final partial 16 block CTR batch. */
+static void ctr_tail_simd128(struct camellia_simd_ctx *ctx, uint8_t *out,
+			     const uint8_t *in, size_t nbytes, uint8_t *iv)
+{
+  uint8_t tmp[16 * 16];
+  uint8_t ctr[16];
+
+  memcpy(ctr, iv, 16);
+  memcpy(tmp, in, nbytes);
+  camellia_ctr_enc_16blks_simd128(ctx, tmp, tmp, ctr);
+  memcpy(out, tmp, nbytes);
+
+  ctr_add(iv, (nbytes + 15) / 16);
+
+  wipe_memory(tmp, sizeof(tmp));
+}
+
+void camellia_ctr_encrypt_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				  const void *vin, size_t nbytes, void *viv)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  uint8_t *iv = viv;
+
+  while (nbytes >= 16 * 16) {
+    camellia_ctr_enc_16blks_simd128(ctx, out, in, iv);
+    out += 16 * 16;
+    in += 16 * 16;
+    nbytes -= 16 * 16;
+  }
+
+  if (nbytes)
+    ctr_tail_simd128(ctx, out, in, nbytes, iv);
+}
+
+/* Processes final partial 16 block CBC decryption batch. */
+static void cbc_dec_tail_simd128(struct camellia_simd_ctx *ctx, uint8_t *out,
+				 const uint8_t *in, size_t nbytes, uint8_t *iv)
+{
+  uint8_t tmp[16 * 16];
+  uint8_t last[16];
+
+  memcpy(last, in + nbytes - 16, 16);
+  memcpy(tmp, in, nbytes);
+  camellia_cbc_dec_16blks_simd128(ctx, tmp, tmp, iv);
+  memcpy(out, tmp, nbytes);
+  memcpy(iv, last, 16);
+
+  wipe_memory(tmp, sizeof(tmp));
+}
+
+int camellia_cbc_decrypt_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				 const void *vin, size_t nbytes, void *viv)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  uint8_t *iv = viv;
+
+  if (nbytes % 16 != 0)
+    return -1;
+
+  while (nbytes >= 16 * 16) {
+    camellia_cbc_dec_16blks_simd128(ctx, out, in, iv);
+    out += 16 * 16;
+    in += 16 * 16;
+    nbytes -= 16 * 16;
+  }
+
+  if (nbytes)
+    cbc_dec_tail_simd128(ctx, out, in, nbytes, iv);
+
+  return 0;
+}
+
+/* Processes final partial 16 block CFB decryption batch. */
+static void cfb_dec_tail_simd128(struct camellia_simd_ctx *ctx, uint8_t *out,
+				 const uint8_t *in, size_t nbytes, uint8_t *iv)
+{
+  uint8_t tmp[16 * 16];
+  uint8_t tmpiv[16];
+
+  memcpy(tmpiv, iv, 16);
+  memcpy(tmp, in, nbytes);
+  camellia_cfb_dec_16blks_simd128(ctx, tmp, tmp, tmpiv);
+  if (nbytes >= 16)
+    memcpy(iv, in + (nbytes / 16 - 1) * 16, 16);
+  memcpy(out, tmp, nbytes);
+
+  wipe_memory(tmp, sizeof(tmp));
+}
+
+void camellia_cfb_decrypt_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				  const void *vin, size_t nbytes, void *viv)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  uint8_t *iv = viv;
+
+  while (nbytes >= 16 * 16) {
+    camellia_cfb_dec_16blks_simd128(ctx, out, in, iv);
+    out += 16 * 16;
+    in += 16 * 16;
+    nbytes -= 16 * 16;
+  }
+
+  if (nbytes)
+    cfb_dec_tail_simd128(ctx, out, in, nbytes, iv);
+}
+
+typedef void (*blks_crypt_iv_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+				   const void *in, void *iv);
+
+/* Processes NBLKS full XTS blocks with 16 block XTS CRYPT. */
+static void xts_crypt_blks_simd128(struct camellia_simd_ctx *ctx, uint8_t *out,
+				   const uint8_t *in, size_t nblks,
+				   uint8_t *tweak, blks_crypt_iv_fn_t crypt)
+{
+  uint8_t tmp[16 * 16];
+  uint8_t t[16];
+
+  while (nblks >= 16) {
+    crypt(ctx, out, in, tweak);
+    out += 16 * 16;
+    in += 16 * 16;
+    nblks -= 16;
+  }
+
+  if (!nblks)
+    return;
+
+  memcpy(t, tweak, 16);
+  memcpy(tmp, in, nblks * 16);
+  crypt(ctx, tmp, tmp, t);
+  memcpy(out, tmp, nblks * 16);
+
+  while (nblks--)
+    xts_mul_x(tweak);
+
+  wipe_memory(tmp, sizeof(tmp));
+}
+
+/* Processes single XTS block with TWEAK, TWEAK is not updated. */
+static void xts_crypt_blk_simd128(struct camellia_simd_ctx *ctx, uint8_t *out,
+				  const uint8_t *in, const uint8_t *tweak,
+				  blks_crypt_iv_fn_t crypt)
+{
+  uint8_t t[16];
+
+  memcpy(t, tweak, 16);
+  xts_crypt_blks_simd128(ctx, out, in, 1, t, crypt);
+}
+
+void camellia_xts_encrypt_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				  const void *vin, size_t nbytes, void *vtweak)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  uint8_t *tweak = vtweak;
+  size_t nblks = nbytes / 16;
+  size_t rem = nbytes % 16;
+  uint8_t pp[16];
+  uint8_t *cc;
+
+  if (!nblks)
+    return;
+
+  xts_crypt_blks_simd128(ctx, out, in, nblks, tweak,
+			 camellia_xts_enc_16blks_simd128);
+  if (!rem)
+    return;
+
+  /* Ciphertext stealing, last full ciphertext block CC is split to final
+   * partial ciphertext block and padding for final partial plaintext
+   * block. */
+  cc = out + (nblks - 1) * 16;
+  memcpy(pp, in + nblks * 16, rem);
+  memcpy(pp + rem, cc + rem, 16 - rem);
+  memcpy(out + nblks * 16, cc, rem);
+  xts_crypt_blk_simd128(ctx, cc, pp, tweak, camellia_xts_enc_16blks_simd128);
+
+  wipe_memory(pp, sizeof(pp));
+}
+
+void camellia_xts_decrypt_simd128(struct camellia_simd_ctx *ctx, void *vout,
+				  const void *vin, size_t nbytes, void *vtweak)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  uint8_t *tweak = vtweak;
+  size_t nblks = nbytes / 16;
+  size_t rem = nbytes % 16;
+  uint8_t next_tweak[16];
+  uint8_t pp[16];
+  uint8_t cc[16];
+
+  if (!nblks)
+    return;
+
+  xts_crypt_blks_simd128(ctx, out, in, nblks - (rem != 0), tweak,
+			 camellia_xts_dec_16blks_simd128);
+  if (!rem)
+    return;
+
+  /* Ciphertext stealing, last full ciphertext block is decrypted with tweak
+   * of final partial block. */
+  out += (nblks - 1) * 16;
+  in += (nblks - 1) * 16;
+  memcpy(next_tweak, tweak, 16);
+  xts_mul_x(next_tweak);
+
+  xts_crypt_blk_simd128(ctx, pp, in, next_tweak,
+			camellia_xts_dec_16blks_simd128);
+  memcpy(cc, in + 16, rem);
+  memcpy(cc + rem, pp + rem, 16 - rem);
+  memcpy(out + 16, pp, rem);
+  xts_crypt_blk_simd128(ctx, out, cc, tweak, camellia_xts_dec_16blks_simd128);
+
+  wipe_memory(pp, sizeof(pp));
+}
+
+/* Encrypts independent CBC streams, NLANES streams at a time with
+ * NLANES block parallel ENCRYPT. Each active lane advances its stream by one
+ * block per call, lanes whose stream is finished are refilled with next
+ * unstarted stream. */
+static void cbc_enc_multi(struct camellia_simd_ctx *ctx,
+			  struct camellia_cbc_stream *streams, size_t nstreams,
+			  unsigned int nlanes, blks_crypt_fn_t encrypt)
+{
+  struct camellia_cbc_stream *lanes[32];
+  size_t pos[32];
+  uint8_t blks[32 * 16];
+  unsigned int nactive = 0;
+  unsigned int i;
+
+  memset(lanes, 0, sizeof(lanes));
+  memset(blks, 0, sizeof(blks));
+
+  while (1) {
+    /* Refill empty lanes. */
+    for (i = 0; i < nlanes && nstreams; i++) {
+      if (lanes[i])
+	continue;
+
+      while (nstreams && streams->nbytes < 16) {
+	streams++;
+	nstreams--;
+      }
+      if (!nstreams)
+	break;
+
+      lanes[i] = streams++;
+      pos[i] = 0;
+      nstreams--;
+      nactive++;
+    }
+
+    if (!nactive)
+      break;
+
+    /* Gather plaintext blocks XORed with chaining values. Inactive lanes
+     * are left as is and their output is discarded. */
+    for (i = 0; i < nlanes; i++) {
+      if (!lanes[i])
+	continue;
+
+      xor_blk(&blks[i * 16], (const uint8_t *)lanes[i]->in + pos[i],
+	      lanes[i]->iv);
+    }
+
+    encrypt(ctx, blks, blks);
+
+    /* Scatter ciphertext blocks and retire finished streams. */
+    for (i = 0; i < nlanes; i++) {
+      if (!lanes[i])
+	continue;
+
+      memcpy((uint8_t *)lanes[i]->out + pos[i], &blks[i * 16], 16);
+      memcpy(lanes[i]->iv, &blks[i * 16], 16);
+      pos[i] += 16;
+
+      if (lanes[i]->nbytes - pos[i] < 16) {
+	lanes[i] = NULL;
+	nactive--;
+      }
+    }
+  }
+
+  wipe_memory(blks, sizeof(blks));
+}
+
+void camellia_cbc_encrypt_multi_simd128(struct camellia_simd_ctx *ctx,
+					struct camellia_cbc_stream *streams,
+					size_t nstreams)
+{
+  cbc_enc_multi(ctx, streams, nstreams, 16, camellia_encrypt_16blks_simd128);
+}
+
+typedef void (*blks_crypt_ocb_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in, void *offset,
+				    void *checksum, const void *Ls);
+
+/* Doubles OCB block SRC to DST, multiplication by x in GF(2^128) in
+ * big-endian block order. */
+static void ocb_double(uint8_t *dst, const uint8_t *src)
+{
+  unsigned int carry = src[0] >> 7;
+  int i;
+
+  for (i = 0; i < 15; i++)
+    dst[i] = (src[i] << 1) | (src[i + 1] >> 7);
+  dst[15] = (src[15] << 1) ^ (0x87 & -carry);
+}
+
+/* Number of trailing zero bits in N, N must be non-zero. */
+static inline unsigned int ntz(uint64_t n)
+{
+  return __builtin_ctzll(n);
+}
+
+/* Encrypts single block with SIMD128 partial batch implementation. */
+static void encrypt_blk(struct camellia_simd_ctx *ctx, uint8_t *out,
+			const uint8_t *in)
+{
+  camellia_encrypt_nblks_simd128(ctx, out, in, 1);
+}
+
+int camellia_ocb_keysetup_simd128(struct camellia_ocb_ctx *ctx,
+				  const void *key, unsigned int keylen)
+{
+  static const uint8_t zero[16];
+  int i;
+
+  /* Assembly implementations of camellia_keysetup_simd128 do not return
+   * status, so key length is checked here. */
+  if (keylen != 16 && keylen != 24 && keylen != 32)
+    return -1;
+
+  camellia_keysetup_simd128(&ctx->cipher, key, keylen);
+
+  encrypt_blk(&ctx->cipher, ctx->L_star, zero);
+  ocb_double(ctx->L_dollar, ctx->L_star);
+  ocb_double(ctx->L[0], ctx->L_dollar);
+  for (i = 1; i < 64; i++)
+    ocb_double(ctx->L[i], ctx->L[i - 1]);
+
+  return 0;
+}
+
+/* Initializes table of 32 offset deltas LS, LS[i] is XOR of L[ntz(j)] for
+ * j = 1..i+1. For batch starting after block number multiple of 16, offset
+ * of block i in batch is offset of previous block XOR LS[i]. Deltas for
+ * batch end blocks (15 and 31) depend on block number and are set with
+ * ocb_set_deltas. */
+static void ocb_init_deltas(const struct camellia_ocb_ctx *ctx, uint8_t *Ls)
+{
+  unsigned int i;
+
+  memcpy(Ls, ctx->L[0], 16);
+  for (i = 1; i < 32; i++)
+    xor_blk(Ls + i * 16, Ls + (i - 1) * 16, ctx->L[ntz(i + 1)]);
+}
+
+/* Sets deltas of batch end blocks in LS for NBLKS block batch following
+ * block number BLKN. */
+static void ocb_set_deltas(const struct camellia_ocb_ctx *ctx, uint8_t *Ls,
+			   unsigned int nblks, uint64_t blkn)
+{
+  unsigned int i;
+
+  for (i = 16; i <= nblks; i += 16)
+    xor_blk(Ls + (i - 1) * 16, Ls + (i - 2) * 16, ctx->L[ntz(blkn + i)]);
+}
+
+/* Computes initial offset from NONCE, for 128-bit tag. */
+static void ocb_nonce_offset(struct camellia_ocb_ctx *ctx, uint8_t *offset,
+			     const uint8_t *nonce, size_t noncelen)
+{
+  uint8_t blk[16];
+  uint8_t stretch[24];
+  unsigned int bottom, shift, i;
+
+  /* Nonce = num2str(TAGLEN mod 128, 7) || zeros || 1 || N */
+  memset(blk, 0, sizeof(blk));
+  memcpy(blk + 16 - noncelen, nonce, noncelen);
+  blk[15 - noncelen] |= 0x01;
+  bottom = blk[15] & 0x3f;
+  blk[15] &= 0xc0;
+
+  /* Stretch = Ktop || (Ktop[1..64] xor Ktop[9..72]) */
+  encrypt_blk(&ctx->cipher, stretch, blk);
+  for (i = 0; i < 8; i++)
+    stretch[16 + i] = stretch[i] ^ stretch[i + 1];
+
+  /* Offset_0 = Stretch[1+bottom..128+bottom] */
+  shift = bottom % 8;
+  for (i = 0; i < 16; i++)
+    offset[i] = (stretch[i + bottom / 8] << shift) |
+		(stretch[i + bottom / 8 + 1] >> (8 - shift));
+
+  wipe_memory(stretch, sizeof(stretch));
+}
+
+/* Computes OCB HASH of associated data AD to SUM with NLANES block parallel
+ * ENCRYPT. */
+static void ocb_hash(struct camellia_ocb_ctx *ctx, uint8_t *sum,
+		     const uint8_t *ad, size_t adlen, uint8_t *Ls,
+		     unsigned int nlanes, blks_crypt_fn_t encrypt)
+{
+  uint8_t tmp[32 * 16];
+  uint8_t offset[16];
+  uint64_t blkn = 0;
+  size_t nblks, i;
+
+  memset(sum, 0, 16);
+  memset(offset, 0, sizeof(offset));
+  memset(tmp, 0, sizeof(tmp));
+
+  while (adlen) {
+    nblks = adlen / 16;
+    if (nblks > nlanes)
+      nblks = nlanes;
+
+    ocb_set_deltas(ctx, Ls, nlanes, blkn);
+    for (i = 0; i < nblks; i++) {
+      xor_blk(tmp + i * 16, ad + i * 16, offset);
+      xor_blk(tmp + i * 16, tmp + i * 16, Ls + i * 16);
+    }
+    if (nblks)
+      xor_blk(offset, offset, Ls + (nblks - 1) * 16);
+
+    blkn += nblks;
+    ad += nblks * 16;
+    adlen -= nblks * 16;
+
+    if (nblks < nlanes && adlen) {
+      /* Final partial block, padded with 10* and offset XOR L_*. */
+      memset(tmp + nblks * 16, 0, 16);
+      memcpy(tmp + nblks * 16, ad, adlen);
+      tmp[nblks * 16 + adlen] = 0x80;
+      xor_blk(offset, offset, ctx->L_star);
+      xor_blk(tmp + nblks * 16, tmp + nblks * 16, offset);
+      nblks++;
+      adlen = 0;
+    }
+
+    encrypt(&ctx->cipher, tmp, tmp);
+    for (i = 0; i < nblks; i++)
+      xor_blk(sum, sum, tmp + i * 16);
+  }
+
+  wipe_memory(tmp, sizeof(tmp));
+}
+
+/* OCB encryption/decryption of NBYTES with NLANES block parallel CRYPT,
+ * remaining blocks are processed with 16 block CRYPT16. Tag is written to
+ * TAG. */
+static void ocb_crypt(struct camellia_ocb_ctx *ctx, uint8_t *out,
+		      const uint8_t *in, size_t nbytes, const uint8_t *nonce,
+		      size_t noncelen, const uint8_t *ad, size_t adlen,
+		      uint8_t *tag, int decrypt, unsigned int nlanes,
+		      blks_crypt_fn_t encrypt, blks_crypt_ocb_fn_t crypt,
+		      blks_crypt_ocb_fn_t crypt16)
+{
+  uint8_t Ls[32 * 16];
+  uint8_t tmp[16 * 16];
+  uint8_t offset[16];
+  uint8_t checksum[16];
+  uint8_t sum[16];
+  uint8_t pad[16];
+  uint8_t tmp_offset[16];
+  uint8_t tmp_checksum[16];
+  uint64_t blkn = 0;
+  size_t nblks, i;
+
+  ocb_init_deltas(ctx, Ls);
+  ocb_hash(ctx, sum, ad, adlen, Ls, nlanes, encrypt);
+  ocb_nonce_offset(ctx, offset, nonce, noncelen);
+  memset(checksum, 0, sizeof(checksum));
+
+  while (nbytes >= nlanes * 16) {
+    ocb_set_deltas(ctx, Ls, nlanes, blkn);
+    crypt(&ctx->cipher, out, in, offset, checksum, Ls);
+    blkn += nlanes;
+    out += nlanes * 16;
+    in += nlanes * 16;
+    nbytes -= nlanes * 16;
+  }
+
+  if (nbytes >= 16 * 16) {
+    ocb_set_deltas(ctx, Ls, 16, blkn);
+    crypt16(&ctx->cipher, out, in, offset, checksum, Ls);
+    blkn += 16;
+    out += 16 * 16;
+    in += 16 * 16;
+    nbytes -= 16 * 16;
+  }
+
+  nblks = nbytes / 16;
+  if (nblks) {
+    /* Final partial 16 block batch through stack buffer. Kernel processes
+     * all 16 blocks, so checksum is accumulated here and offset is advanced
+     * by delta of last full block. */
+    memset(tmp, 0, sizeof(tmp));
+    memcpy(tmp, in, nblks * 16);
+    memcpy(tmp_offset, offset, 16);
+    memset(tmp_checksum, 0, 16);
+    crypt16(&ctx->cipher, tmp, tmp, tmp_offset, tmp_checksum, Ls);
+    for (i = 0; i < nblks; i++)
+      xor_blk(checksum, checksum, (decrypt ? tmp : in) + i * 16);
+    memcpy(out, tmp, nblks * 16);
+    xor_blk(offset, offset, Ls + (nblks - 1) * 16);
+    out += nblks * 16;
+    in += nblks * 16;
+    nbytes -= nblks * 16;
+  }
+
+  if (nbytes) {
+    /* Final partial block, XORed with Pad = ENCIPHER(K, Offset_*) and
+     * padded with 10* for checksum. */
+    xor_blk(offset, offset, ctx->L_star);
+    encrypt_blk(&ctx->cipher, pad, offset);
+    memset(tmp, 0, 16);
+    for (i = 0; i < nbytes; i++) {
+      uint8_t b = in[i];
+
+      out[i] = b ^ pad[i];
+      tmp[i] = decrypt ? out[i] : b;
+    }
+    tmp[nbytes] = 0x80;
+    xor_blk(checksum, checksum, tmp);
+  }
+
+  /* Tag = ENCIPHER(K, Checksum XOR Offset XOR L_$) XOR HASH(K, A) */
+  xor_blk(tmp, checksum, offset);
+  xor_blk(tmp, tmp, ctx->L_dollar);
+  encrypt_blk(&ctx->cipher, tmp, tmp);
+  xor_blk(tag, tmp, sum);
+
+  wipe_memory(tmp, sizeof(tmp));
+  wipe_memory(tmp_checksum, sizeof(tmp_checksum));
+  wipe_memory(checksum, sizeof(checksum));
+  wipe_memory(pad, sizeof(pad));
+}
+
+/* Compares LEN byte tags in constant time, returns 0 if tags match and -1
+ * otherwise. */
+static int check_tag(const uint8_t *a, const uint8_t *b, unsigned int len)
+{
+  unsigned int diff = 0;
+  unsigned int i;
+
+  for (i = 0; i < len; i++)
+    diff |= a[i] ^ b[i];
+
+  return -(int)((diff + 0xff) >> 8);
+}
+
+void camellia_ocb_encrypt_simd128(struct camellia_ocb_ctx *ctx, void *out,
+				  const void *in, size_t nbytes,
+				  const void *nonce, size_t noncelen,
+				  const void *ad, size_t adlen, void *tag)
+{
+  ocb_crypt(ctx, out, in, nbytes, nonce, noncelen, ad, adlen, tag, 0, 16,
+	    camellia_encrypt_16blks_simd128, camellia_ocb_enc_16blks_simd128,
+	    camellia_ocb_enc_16blks_simd128);
+}
+
+int camellia_ocb_decrypt_simd128(struct camellia_ocb_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *nonce, size_t noncelen,
+				 const void *ad, size_t adlen, const void *tag)
+{
+  uint8_t t[16];
+
+  ocb_crypt(ctx, out, in, nbytes, nonce, noncelen, ad, adlen, t, 1, 16,
+	    camellia_encrypt_16blks_simd128, camellia_ocb_dec_16blks_simd128,
+	    camellia_ocb_dec_16blks_simd128);
+
+  return check_tag(t, tag, 16);
+}
+
+typedef void (*ghash_fn_t)(void *hash, const void *Htable, const void *in,
+			   size_t nblks);
+typedef void (*blks_crypt_gcm_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+				    const void *in, void *iv, void *hash,
+				    const void *Htable, const void *ghash_in);
+
+/* Multiplies X and Y in GF(2^128) with GCM bit order to R. Only used for
+ * computing hash key powers at key setup. */
+static void gcm_gfmul(uint8_t *r, const uint8_t *x, const uint8_t *y)
+{
+  uint8_t z[16], v[16];
+  unsigned int i, j, mask, carry;
+
+  memset(z, 0, sizeof(z));
+  memcpy(v, y, 16);
+
+  for (i = 0; i < 128; i++) {
+    mask = -((x[i / 8] >> (7 - i % 8)) & 1);
+    for (j = 0; j < 16; j++)
+      z[j] ^= v[j] & mask;
+
+    carry = v[15] & 1;
+    for (j = 15; j > 0; j--)
+      v[j] = (v[j] >> 1) | (v[j - 1] << 7);
+    v[0] = (v[0] >> 1) ^ (0xe1 & -carry);
+  }
+
+  memcpy(r, z, 16);
+  wipe_memory(v, sizeof(v));
+}
+
+int camellia_gcm_keysetup_simd128(struct camellia_gcm_ctx *ctx,
+				  const void *key, unsigned int keylen)
+{
+  static const uint8_t zero[16];
+  uint8_t H[16], Hi[16];
+  int i, j;
+
+  /* Assembly implementations of camellia_keysetup_simd128 do not return
+   * status, so key length is checked here. */
+  if (keylen != 16 && keylen != 24 && keylen != 32)
+    return -1;
+
+  camellia_keysetup_simd128(&ctx->cipher, key, keylen);
+
+  encrypt_blk(&ctx->cipher, H, zero);
+  memcpy(Hi, H, 16);
+  for (i = 0; i < 16; i++) {
+    for (j = 0; j < 16; j++)
+      ctx->Htable[15 - i][j] = Hi[15 - j];
+    gcm_gfmul(Hi, Hi, H);
+  }
+
+  wipe_memory(H, sizeof(H));
+  wipe_memory(Hi, sizeof(Hi));
+  return 0;
+}
+
+/* Increments lowest 32 bits of 16 byte big-endian counter CTR (inc32). */
+static void gcm_ctr32_inc(uint8_t *ctr)
+{
+  unsigned int i;
+
+  for (i = 16; i > 12; i--) {
+    if (++ctr[i - 1] != 0)
+      break;
+  }
+}
+
+/* Returns non-zero if NBLKS counter blocks starting from CTR can be generated
+ * with 128-bit increments by CTR mode kernels, that is, lowest 32-bit word
+ * of counter does not wrap. */
+static int gcm_ctr32_fits(const uint8_t *ctr, size_t nblks)
+{
+  uint32_t lo = ((uint32_t)ctr[12] << 24) | ((uint32_t)ctr[13] << 16) |
+		((uint32_t)ctr[14] << 8) | ctr[15];
+
+  return lo <= 0xffffffffU - nblks;
+}
+
+/* CTR mode with 32-bit counter increments for NBYTES (at most NLANES blocks)
+ * through stack buffer with NLANES block parallel ENCRYPT. */
+static void gcm_ctr32_blks(struct camellia_simd_ctx *ctx, uint8_t *out,
+			   const uint8_t *in, size_t nbytes, uint8_t *ctr,
+			   unsigned int nlanes, blks_crypt_fn_t encrypt)
+{
+  uint8_t tmp[32 * 16];
+  size_t i;
+
+  memset(tmp, 0, nlanes * 16);
+  for (i = 0; i < (nbytes + 15) / 16; i++) {
+    memcpy(tmp + i * 16, ctr, 16);
+    gcm_ctr32_inc(ctr);
+  }
+
+  encrypt(ctx, tmp, tmp);
+  for (i = 0; i < nbytes; i++)
+    out[i] = in[i] ^ tmp[i];
+
+  wipe_memory(tmp, sizeof(tmp));
+}
+
+/* Updates GHASH (or POLYVAL) state HASH with NBYTES from IN, final partial
+ * block is padded with zeros. */
+static void gcm_ghash_pad(const void *Htable, uint8_t *hash,
+			  const uint8_t *in, size_t nbytes, ghash_fn_t ghash)
+{
+  uint8_t tmp[16];
+
+  if (nbytes >= 16)
+    ghash(hash, Htable, in, nbytes / 16);
+
+  if (nbytes % 16) {
+    memset(tmp, 0, sizeof(tmp));
+    memcpy(tmp, in + nbytes - nbytes % 16, nbytes % 16);
+    ghash(hash, Htable, tmp, 1);
+    wipe_memory(tmp, sizeof(tmp));
+  }
+}
+
+/* Updates GHASH state HASH with length block of bit lengths A and C. */
+static void gcm_ghash_lengths(struct camellia_gcm_ctx *ctx, uint8_t *hash,
+			      uint64_t a, uint64_t c, ghash_fn_t ghash)
+{
+  uint8_t tmp[16];
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    tmp[7 - i] = (a * 8) >> (i * 8);
+    tmp[15 - i] = (c * 8) >> (i * 8);
+  }
+
+  ghash(hash, ctx->Htable, tmp, 1);
+}
+
+/* GCM encryption/decryption of NBYTES with NLANES block parallel kernels.
+ * Full batches are processed with fused GCM kernel GCM, which hashes the
+ * input batch for decryption and the previous output batch for encryption
+ * while encrypting counter blocks. Tag is written to TAG. */
+static void gcm_crypt(struct camellia_gcm_ctx *ctx, uint8_t *out,
+		      const uint8_t *in, size_t nbytes, const uint8_t *iv,
+		      size_t ivlen, const uint8_t *ad, size_t adlen,
+		      uint8_t *tag, int decrypt, unsigned int nlanes,
+		      blks_crypt_fn_t encrypt, blks_crypt_iv_fn_t ctr_enc,
+		      blks_crypt_gcm_fn_t gcm, ghash_fn_t ghash)
+{
+  const uint8_t *pending = NULL;
+  uint8_t j0[16];
+  uint8_t ctr[16];
+  uint8_t hash[16];
+  uint64_t total = nbytes;
+
+  /* Pre-counter block J0. */
+  if (ivlen == 12) {
+    memcpy(j0, iv, 12);
+    memset(j0 + 12, 0, 3);
+    j0[15] = 1;
+  } else {
+    memset(j0, 0, sizeof(j0));
+    gcm_ghash_pad(ctx->Htable, j0, iv, ivlen, ghash);
+    gcm_ghash_lengths(ctx, j0, 0, ivlen, ghash);
+  }
+  memcpy(ctr, j0, 16);
+  gcm_ctr32_inc(ctr);
+
+  memset(hash, 0, sizeof(hash));
+  gcm_ghash_pad(ctx->Htable, hash, ad, adlen, ghash);
+
+  while (nbytes >= nlanes * 16) {
+    const uint8_t *ghash_in = decrypt ? in : pending;
+
+    if (ghash_in && gcm_ctr32_fits(ctr, nlanes)) {
+      gcm(&ctx->cipher, out, in, ctr, hash, ctx->Htable, ghash_in);
+    } else {
+      if (ghash_in)
+	ghash(hash, ctx->Htable, ghash_in, nlanes);
+      if (gcm_ctr32_fits(ctr, nlanes))
+	ctr_enc(&ctx->cipher, out, in, ctr);
+      else
+	gcm_ctr32_blks(&ctx->cipher, out, in, nlanes * 16, ctr, nlanes,
+		       encrypt);
+    }
+
+    pending = out;
+    out += nlanes * 16;
+    in += nlanes * 16;
+    nbytes -= nlanes * 16;
+  }
+
+  /* Last full output batch is not yet hashed for encryption. */
+  if (!decrypt && pending)
+    ghash(hash, ctx->Htable, pending, nlanes);
+
+  if (nbytes) {
+    if (decrypt)
+      gcm_ghash_pad(ctx->Htable, hash, in, nbytes, ghash);
+    gcm_ctr32_blks(&ctx->cipher, out, in, nbytes, ctr, nlanes, encrypt);
+    if (!decrypt)
+      gcm_ghash_pad(ctx->Htable, hash, out, nbytes, ghash);
+  }
+
+  /* Tag = ENCIPHER(K, J0) XOR GHASH(A || C || len(A) || len(C)) */
+  gcm_ghash_lengths(ctx, hash, adlen, total, ghash);
+  encrypt_blk(&ctx->cipher, tag, j0);
+  xor_blk(tag, tag, hash);
+
+  wipe_memory(hash, sizeof(hash));
+}
+
+void camellia_gcm_encrypt_simd128(struct camellia_gcm_ctx *ctx, void *out,
+				  const void *in, size_t nbytes,
+				  const void *iv, size_t ivlen,
+				  const void *ad, size_t adlen, void *tag)
+{
+  gcm_crypt(ctx, out, in, nbytes, iv, ivlen, ad, adlen, tag, 0, 16,
+	    camellia_encrypt_16blks_simd128, camellia_ctr_enc_16blks_simd128,
+	    camellia_gcm_16blks_simd128, camellia_ghash_simd128);
+}
+
+int camellia_gcm_decrypt_simd128(struct camellia_gcm_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *iv, size_t ivlen,
+				 const void *ad, size_t adlen, const void *tag)
+{
+  uint8_t t[16];
+
+  gcm_crypt(ctx, out, in, nbytes, iv, ivlen, ad, adlen, t, 1, 16,
+	    camellia_encrypt_16blks_simd128, camellia_ctr_enc_16blks_simd128,
+	    camellia_gcm_16blks_simd128, camellia_ghash_simd128);
+
+  return check_tag(t, tag, 16);
+}
+
+/* Multiplies X by x in GF(2^128) with GCM bit order (mulX_GHASH). */
+static void gcm_mul_x(uint8_t *x)
+{
+  unsigned int carry = x[15] & 1;
+  int i;
+
+  for (i = 15; i > 0; i--)
+    x[i] = (x[i] >> 1) | (x[i - 1] << 7);
+  x[0] = (x[0] >> 1) ^ (0xe1 & -carry);
+}
+
+int camellia_gcm_siv_keysetup_simd128(struct camellia_gcm_siv_ctx *ctx,
+				      const void *key, unsigned int keylen)
+{
+  /* Key derivation of RFC 8452 is defined for 128-bit and 256-bit keys. */
+  if (keylen != 16 && keylen != 32)
+    return -1;
+
+  camellia_keysetup_simd128(&ctx->cipher, key, keylen);
+  return 0;
+}
+
+/* Derives per-nonce message authentication key AUTH_KEY and message
+ * encryption key ENC_CTX from key-generating key. All key derivation blocks
+ * are encrypted with one parallel call. */
+static void gcm_siv_derive_keys(struct camellia_gcm_siv_ctx *ctx,
+				uint8_t *auth_key,
+				struct camellia_simd_ctx *enc_ctx,
+				const uint8_t *nonce)
+{
+  uint8_t blks[16 * 16];
+  uint8_t key[32];
+  unsigned int keylen = ctx->cipher.key_length;
+  unsigned int i;
+
+  /* Block i is LE32(i) || NONCE, first half of each output block is used. */
+  memset(blks, 0, sizeof(blks));
+  for (i = 0; i < 2 + keylen / 8; i++) {
+    blks[i * 16] = i;
+    memcpy(blks + i * 16 + 4, nonce, 12);
+  }
+
+  camellia_encrypt_16blks_simd128(&ctx->cipher, blks, blks);
+
+  memcpy(auth_key, blks, 8);
+  memcpy(auth_key + 8, blks + 16, 8);
+  for (i = 0; i < keylen / 8; i++)
+    memcpy(key + i * 8, blks + (i + 2) * 16, 8);
+
+  camellia_keysetup_simd128(enc_ctx, key, keylen);
+
+  wipe_memory(blks, sizeof(blks));
+  wipe_memory(key, sizeof(key));
+}
+
+/* Sets up last NPOW entries of HTABLE for POLYVAL key KEY. Hash key for
+ * GHASH domain is H = mulX_GHASH(ByteReverse(KEY)) and HTABLE[15] is H in
+ * byte-reversed order. Higher powers are computed with POLYVAL itself, as
+ * POLYVAL of byte-reversed H^i with zero state is byte-reversed H^(i+1). */
+static void gcm_siv_htable(uint8_t (*Htable)[16], const uint8_t *key,
+			   unsigned int npow, ghash_fn_t polyval)
+{
+  uint8_t H[16];
+  unsigned int i;
+
+  for (i = 0; i < 16; i++)
+    H[i] = key[15 - i];
+  gcm_mul_x(H);
+  for (i = 0; i < 16; i++)
+    Htable[15][i] = H[15 - i];
+
+  for (i = 1; i < npow; i++) {
+    memset(Htable[15 - i], 0, 16);
+    polyval(Htable[15 - i], Htable, Htable[16 - i], 1);
+  }
+
+  wipe_memory(H, sizeof(H));
+}
+
+/* GCM-SIV CTR mode for NBYTES (at most NLANES blocks) through stack buffer
+ * with NLANES block parallel ENCRYPT. First four bytes of CTR are 32-bit
+ * little-endian block counter, which wraps without carry to rest of CTR. */
+static void gcm_siv_ctr_blks(struct camellia_simd_ctx *ctx, uint8_t *out,
+			     const uint8_t *in, size_t nbytes, uint8_t *ctr,
+			     unsigned int nlanes, blks_crypt_fn_t encrypt)
+{
+  uint8_t tmp[32 * 16];
+  uint32_t c = ((uint32_t)ctr[3] << 24) | ((uint32_t)ctr[2] << 16) |
+	       ((uint32_t)ctr[1] << 8) | ctr[0];
+  size_t nblks = (nbytes + 15) / 16;
+  size_t i;
+
+  memset(tmp, 0, nlanes * 16);
+  for (i = 0; i < nblks; i++, c++) {
+    memcpy(tmp + i * 16, ctr, 16);
+    tmp[i * 16 + 0] = c;
+    tmp[i * 16 + 1] = c >> 8;
+    tmp[i * 16 + 2] = c >> 16;
+    tmp[i * 16 + 3] = c >> 24;
+  }
+  ctr[0] = c;
+  ctr[1] = c >> 8;
+  ctr[2] = c >> 16;
+  ctr[3] = c >> 24;
+
+  encrypt(ctx, tmp, tmp);
+  for (i = 0; i + 16 <= nbytes; i += 16)
+    xor_blk(out + i, in + i, tmp + i);
+  for (; i < nbytes; i++)
+    out[i] = in[i] ^ tmp[i];
+
+  wipe_memory(tmp, sizeof(tmp));
+}
+
+/* GCM-SIV encryption/decryption of NBYTES with NLANES block parallel
+ * kernels. Encryption computes POLYVAL of plaintext before CTR encryption,
+ * decryption computes POLYVAL of each decrypted batch after CTR decryption.
+ * For encryption, tag is written to TAG. For decryption, TAG is received tag
+ * on entry, used as initial counter, and is replaced with computed tag. */
+static void gcm_siv_crypt(struct camellia_gcm_siv_ctx *ctx, uint8_t *out,
+			  const uint8_t *in, size_t nbytes,
+			  const uint8_t *nonce, const uint8_t *ad,
+			  size_t adlen, uint8_t *tag, int decrypt,
+			  unsigned int nlanes, blks_crypt_fn_t encrypt,
+			  ghash_fn_t polyval)
+{
+  struct camellia_simd_ctx enc_ctx;
+  uint8_t Htable[16][16];
+  uint8_t auth_key[16];
+  uint8_t hash[16];
+  uint8_t ctr[16];
+  size_t maxblks = (adlen > nbytes ? adlen : nbytes) / 16;
+  size_t pos, n;
+  int i;
+
+  gcm_siv_derive_keys(ctx, auth_key, &enc_ctx, nonce);
+
+  /* Only powers used by longest POLYVAL call are needed. */
+  gcm_siv_htable(Htable, auth_key,
+		 maxblks >= 16 ? 16 : maxblks ? maxblks : 1, polyval);
+
+  memset(hash, 0, sizeof(hash));
+  gcm_ghash_pad(Htable, hash, ad, adlen, polyval);
+  if (!decrypt)
+    gcm_ghash_pad(Htable, hash, in, nbytes, polyval);
+
+  /* Encryption uses counter derived from the tag, which for decryption is
+   * available before plaintext. */
+  if (decrypt) {
+    memcpy(ctr, tag, 16);
+    ctr[15] |= 0x80;
+    for (pos = 0; pos < nbytes; pos += n) {
+      n = nbytes - pos < nlanes * 16 ? nbytes - pos : nlanes * 16;
+      gcm_siv_ctr_blks(&enc_ctx, out + pos, in + pos, n, ctr, nlanes,
+		       encrypt);
+      gcm_ghash_pad(Htable, hash, out + pos, n, polyval);
+    }
+  }
+
+  /* Length block is LE64(len(A)) || LE64(len(P)) in bits. */
+  for (i = 0; i < 8; i++) {
+    ctr[i] = ((uint64_t)adlen * 8) >> (i * 8);
+    ctr[8 + i] = ((uint64_t)nbytes * 8) >> (i * 8);
+  }
+  polyval(hash, Htable, ctr, 1);
+
+  /* Tag = ENCIPHER(K_enc, (S XOR NONCE) with MSB of last byte cleared) */
+  for (i = 0; i < 12; i++)
+    hash[i] ^= nonce[i];
+  hash[15] &= 0x7f;
+  encrypt_blk(&enc_ctx, tag, hash);
+
+  if (!decrypt) {
+    memcpy(ctr, tag, 16);
+    ctr[15] |= 0x80;
+    for (pos = 0; pos < nbytes; pos += n) {
+      n = nbytes - pos < nlanes * 16 ? nbytes - pos : nlanes * 16;
+      gcm_siv_ctr_blks(&enc_ctx, out + pos, in + pos, n, ctr, nlanes,
+		       encrypt);
+    }
+  }
+
+  wipe_memory(&enc_ctx, sizeof(enc_ctx));
+  wipe_memory(Htable, sizeof(Htable));
+  wipe_memory(auth_key, sizeof(auth_key));
+  wipe_memory(hash, sizeof(hash));
+  wipe_memory(ctr, sizeof(ctr));
+}
+
+void camellia_gcm_siv_encrypt_simd128(struct camellia_gcm_siv_ctx *ctx,
+				      void *out, const void *in, size_t nbytes,
+				      const void *nonce, const void *ad,
+				      size_t adlen, void *tag)
+{
+  gcm_siv_crypt(ctx, out, in, nbytes, nonce, ad, adlen, tag, 0, 16,
+		camellia_encrypt_16blks_simd128, camellia_polyval_simd128);
+}
+
+int camellia_gcm_siv_decrypt_simd128(struct camellia_gcm_siv_ctx *ctx,
+				     void *out, const void *in, size_t nbytes,
+				     const void *nonce, const void *ad,
+				     size_t adlen, const void *tag)
+{
+  uint8_t t[16];
+
+  memcpy(t, tag, 16);
+  gcm_siv_crypt(ctx, out, in, nbytes, nonce, ad, adlen, t, 1, 16,
+		camellia_encrypt_16blks_simd128, camellia_polyval_simd128);
+
+  return check_tag(t, tag, 16);
+}
+
+/* Keystream batch for multi-message CCM and SIV. Counter blocks of several
+ * messages are gathered to one parallel encryption and keystream is XORed to
+ * each block's destination when batch is flushed. */
+struct ks_batch
+{
+  uint8_t blks[32 * 16];
+  uint8_t *out[32];
+  const uint8_t *in[32];
+  unsigned int nbytes[32];
+  unsigned int n;
+};
+
+static void ks_flush(struct camellia_simd_ctx *ctx,
+			 struct ks_batch *b, blks_crypt_fn_t encrypt)
+{
+  unsigned int i, j;
+
+  if (!b->n)
+    return;
+
+  encrypt(ctx, b->blks, b->blks);
+
+  for (i = 0; i < b->n; i++) {
+    if (b->nbytes[i] == 16) {
+      xor_blk(b->out[i], b->in[i], &b->blks[i * 16]);
+      continue;
+    }
+    for (j = 0; j < b->nbytes[i]; j++)
+      b->out[i][j] = b->in[i][j] ^ b->blks[i * 16 + j];
+  }
+
+  b->n = 0;
+}
+
+static void ks_add(struct camellia_simd_ctx *ctx, struct ks_batch *b,
+		       const uint8_t *ctr, uint8_t *out, const uint8_t *in,
+		       unsigned int nbytes, unsigned int nlanes,
+		       blks_crypt_fn_t encrypt)
+{
+  memcpy(&b->blks[b->n * 16], ctr, 16);
+  b->out[b->n] = out;
+  b->in[b->n] = in;
+  b->nbytes[b->n] = nbytes;
+
+  if (++b->n == nlanes)
+    ks_flush(ctx, b, encrypt);
+}
+
+/* Sets CTR to CCM counter block A_0 of MSG. */
+static void ccm_ctr0(uint8_t *ctr, const struct camellia_ccm_msg *msg)
+{
+  memset(ctr, 0, 16);
+  ctr[0] = 14 - msg->noncelen;
+  memcpy(&ctr[1], msg->nonce, msg->noncelen);
+}
+
+/* CTR mode of NBYTES of one message with big-endian counter CTR. Full
+ * NLANES block batches go to the fused CTR_ENC kernel and remaining blocks
+ * are added to keystream batch B shared with other messages. */
+static void ks_ctr(struct camellia_simd_ctx *ctx, struct ks_batch *b,
+		   uint8_t *out, const uint8_t *in, size_t nbytes,
+		   uint8_t *ctr, unsigned int nlanes, blks_crypt_fn_t encrypt,
+		   blks_crypt_iv_fn_t ctr_enc)
+{
+  while (nbytes >= nlanes * 16) {
+    ctr_enc(ctx, out, in, ctr);
+    out += nlanes * 16;
+    in += nlanes * 16;
+    nbytes -= nlanes * 16;
+  }
+
+  while (nbytes) {
+    unsigned int n = nbytes < 16 ? nbytes : 16;
+
+    ks_add(ctx, b, ctr, out, in, n, nlanes, encrypt);
+    ctr_add(ctr, 1);
+    out += n;
+    in += n;
+    nbytes -= n;
+  }
+}
+
+/* CTR half of CCM: payload of MSG with counter blocks A_1, A_2, ... */
+static void ccm_ctr(struct camellia_simd_ctx *ctx, struct ks_batch *b,
+		    const struct camellia_ccm_msg *msg, unsigned int nlanes,
+		    blks_crypt_fn_t encrypt, blks_crypt_iv_fn_t ctr_enc)
+{
+  uint8_t ctr[16];
+
+  ccm_ctr0(ctr, msg);
+  ctr[15] = 1;
+
+  ks_ctr(ctx, b, msg->out, msg->in, msg->nbytes, ctr, nlanes, encrypt,
+	 ctr_enc);
+}
+
+/* CBC-MAC lane of multi-message CCM. Lane processes blocks A_0 (for tag
+ * encryption key S_0), B_0, associated data blocks and payload blocks of
+ * one message, one block per parallel encryption. */
+struct ccm_lane
+{
+  struct camellia_ccm_msg *msg;
+  const uint8_t *payload;
+  size_t blk;
+  size_t nadblks;
+  size_t nblks;
+  uint8_t hdr[10];
+  unsigned int hdrlen;
+  uint8_t s0[16];
+};
+
+static void ccm_lane_init(struct ccm_lane *lane, struct camellia_ccm_msg *msg,
+			  int decrypt)
+{
+  uint64_t adlen = msg->adlen;
+  unsigned int prefixlen;
+  unsigned int i;
+
+  lane->msg = msg;
+  lane->payload = decrypt ? msg->out : msg->in;
+  lane->blk = 0;
+
+  /* Length encoding of associated data: optional 0xff 0xfe or 0xff 0xff
+   * marker followed by big-endian length. */
+  prefixlen = 0;
+  if (adlen == 0) {
+    lane->hdrlen = 0;
+  } else if (adlen < 0xff00) {
+    lane->hdrlen = 2;
+  } else {
+    prefixlen = 2;
+    lane->hdr[0] = 0xff;
+    lane->hdr[1] = adlen <= 0xffffffffU ? 0xfe : 0xff;
+    lane->hdrlen = adlen <= 0xffffffffU ? 6 : 10;
+  }
+  for (i = lane->hdrlen; i > prefixlen; i--) {
+    lane->hdr[i - 1] = adlen & 0xff;
+    adlen >>= 8;
+  }
+
+  lane->nadblks = msg->adlen ? (lane->hdrlen + msg->adlen + 15) / 16 : 0;
+  lane->nblks = 2 + lane->nadblks + (msg->nbytes + 15) / 16;
+}
+
+/* Formats block BLK of lane's CBC-MAC input to B. */
+static void ccm_lane_blk(const struct ccm_lane *lane, size_t blk, uint8_t *b)
+{
+  const struct camellia_ccm_msg *msg = lane->msg;
+  size_t nbytes = msg->nbytes;
+  size_t pos, n;
+  unsigned int i;
+
+  memset(b, 0, 16);
+
+  if (blk == 0) {
+    ccm_ctr0(b, msg);
+    return;
+  }
+
+  if (blk == 1) {
+    b[0] = (msg->adlen ? 0x40 : 0) | (((msg->taglen - 2) / 2) << 3) |
+	   (14 - msg->noncelen);
+    memcpy(&b[1], msg->nonce, msg->noncelen);
+    for (i = 15; i > msg->noncelen; i--) {
+      b[i] = nbytes & 0xff;
+      nbytes >>= 8;
+    }
+    return;
+  }
+
+  blk -= 2;
+  if (blk < lane->nadblks) {
+    /* Associated data is prefixed with its length encoding. */
+    pos = blk * 16;
+    for (i = 0; i < 16 && pos < lane->hdrlen; i++, pos++)
+      b[i] = lane->hdr[pos];
+    pos -= lane->hdrlen;
+    if (pos < msg->adlen) {
+      n = msg->adlen - pos < 16 - i ? msg->adlen - pos : 16 - i;
+      memcpy(&b[i], (const uint8_t *)msg->ad + pos, n);
+    }
+    return;
+  }
+
+  pos = (blk - lane->nadblks) * 16;
+  n = nbytes - pos < 16 ? nbytes - pos : 16;
+  memcpy(b, lane->payload + pos, n);
+}
+
+/* CBC-MAC half of CCM. CBC-MAC is serial within message, so each parallel
+ * block lane is assigned its own message and lanes are refilled with next
+ * messages as messages finish. Encryption writes tags to messages,
+ * decryption checks them and returns -1 if any tag does not match. */
+static int ccm_mac_multi(struct camellia_simd_ctx *ctx,
+			 struct camellia_ccm_msg *msgs, size_t nmsgs,
+			 int decrypt, unsigned int nlanes,
+			 blks_crypt_fn_t encrypt)
+{
+  struct ccm_lane lanes[32];
+  uint8_t blks[32 * 16];
+  uint8_t b[16];
+  unsigned int nactive = 0;
+  unsigned int i;
+  int ret = 0;
+
+  memset(blks, 0, sizeof(blks));
+  for (i = 0; i < nlanes; i++)
+    lanes[i].msg = NULL;
+
+  while (1) {
+    /* Refill empty lanes. */
+    for (i = 0; i < nlanes && nmsgs; i++) {
+      if (lanes[i].msg)
+	continue;
+
+      ccm_lane_init(&lanes[i], msgs++, decrypt);
+      nmsgs--;
+      nactive++;
+    }
+
+    if (!nactive)
+      break;
+
+    /* Gather next block of each lane, XORed with CBC-MAC chaining value
+     * after B_0. Inactive lanes are left as is and their output is
+     * discarded. */
+    for (i = 0; i < nlanes; i++) {
+      if (!lanes[i].msg)
+	continue;
+
+      if (lanes[i].blk < 2) {
+	ccm_lane_blk(&lanes[i], lanes[i].blk, &blks[i * 16]);
+      } else {
+	ccm_lane_blk(&lanes[i], lanes[i].blk, b);
+	xor_blk(&blks[i * 16], &blks[i * 16], b);
+      }
+    }
+
+    encrypt(ctx, blks, blks);
+
+    /* Store S_0, finish tags and retire finished messages. */
+    for (i = 0; i < nlanes; i++) {
+      struct camellia_ccm_msg *msg = lanes[i].msg;
+
+      if (!msg)
+	continue;
+
+      if (lanes[i].blk == 0)
+	memcpy(lanes[i].s0, &blks[i * 16], 16);
+
+      if (++lanes[i].blk < lanes[i].nblks)
+	continue;
+
+      xor_blk(b, &blks[i * 16], lanes[i].s0);
+      if (decrypt) {
+	msg->status = check_tag(b, msg->tag, msg->taglen);
+	ret |= msg->status;
+      } else {
+	memcpy(msg->tag, b, msg->taglen);
+	msg->status = 0;
+      }
+
+      lanes[i].msg = NULL;
+      nactive--;
+    }
+  }
+
+  wipe_memory(blks, sizeof(blks));
+  wipe_memory(lanes, sizeof(lanes));
+  wipe_memory(b, sizeof(b));
+
+  return ret;
+}
+
+/* Multi-message CCM. Encryption computes CBC-MACs of plaintext before CTR
+ * encryption, decryption computes CBC-MACs of plaintext after CTR
+ * decryption, so messages may be processed in-place. */
+static int ccm_crypt_multi(struct camellia_simd_ctx *ctx,
+			   struct camellia_ccm_msg *msgs, size_t nmsgs,
+			   int decrypt, unsigned int nlanes,
+			   blks_crypt_fn_t encrypt, blks_crypt_iv_fn_t ctr_enc)
+{
+  struct ks_batch b;
+  size_t i;
+  int ret = 0;
+
+  if (!decrypt)
+    ret = ccm_mac_multi(ctx, msgs, nmsgs, 0, nlanes, encrypt);
+
+  b.n = 0;
+  for (i = 0; i < nmsgs; i++)
+    ccm_ctr(ctx, &b, &msgs[i], nlanes, encrypt, ctr_enc);
+  ks_flush(ctx, &b, encrypt);
+  wipe_memory(b.blks, sizeof(b.blks));
+
+  if (decrypt)
+    ret = ccm_mac_multi(ctx, msgs, nmsgs, 1, nlanes, encrypt);
+
+  return ret;
+}
+
+void camellia_ccm_encrypt_multi_simd128(struct camellia_simd_ctx *ctx,
+					struct camellia_ccm_msg *msgs,
+					size_t nmsgs)
+{
+  ccm_crypt_multi(ctx, msgs, nmsgs, 0, 16, camellia_encrypt_16blks_simd128,
+		  camellia_ctr_enc_16blks_simd128);
+}
+
+int camellia_ccm_decrypt_multi_simd128(struct camellia_simd_ctx *ctx,
+				       struct camellia_ccm_msg *msgs,
+				       size_t nmsgs)
+{
+  return ccm_crypt_multi(ctx, msgs, nmsgs, 1, 16,
+			 camellia_encrypt_16blks_simd128,
+			 camellia_ctr_enc_16blks_simd128);
+}
+
+int camellia_cmac_keysetup_simd128(struct camellia_cmac_ctx *ctx,
+				   const void *key, unsigned int keylen)
+{
+  static const uint8_t zero[16];
+  uint8_t L[16];
+
+  /* Assembly implementations of camellia_keysetup_simd128 do not return
+   * status, so key length is checked here. */
+  if (keylen != 16 && keylen != 24 && keylen != 32)
+    return -1;
+
+  camellia_keysetup_simd128(&ctx->cipher, key, keylen);
+
+  /* Subkey doubling is same as in OCB. */
+  encrypt_blk(&ctx->cipher, L, zero);
+  ocb_double(ctx->K1, L);
+  ocb_double(ctx->K2, ctx->K1);
+
+  wipe_memory(L, sizeof(L));
+  return 0;
+}
+
+/* Input of batched CMAC: LEN bytes at MSG. If XOREND is non-NULL, its 16
+ * bytes are XORed to last 16 bytes of message (xorend of SIV S2V, LEN must
+ * be at least 16). CMAC is written to MAC. */
+struct cmac_item
+{
+  const uint8_t *msg;
+  size_t len;
+  const uint8_t *xorend;
+  uint8_t *mac;
+};
+
+/* Gets CMAC input block at offset POS of ITEM to B, final block is XORed
+ * with K1 if complete and padded and XORed with K2 otherwise. */
+static void cmac_item_blk(const struct camellia_cmac_ctx *ctx,
+			  const struct cmac_item *item, size_t pos, uint8_t *b)
+{
+  size_t left = item->len - pos;
+  size_t n = left < 16 ? left : 16;
+  size_t j;
+
+  memset(b, 0, 16);
+  memcpy(b, item->msg + pos, n);
+
+  if (item->xorend) {
+    for (j = 0; j < n; j++) {
+      if (pos + j >= item->len - 16)
+	b[j] ^= item->xorend[pos + j - (item->len - 16)];
+    }
+  }
+
+  if (left > 16)
+    return;
+
+  if (left == 16) {
+    xor_blk(b, b, ctx->K1);
+  } else {
+    b[left] = 0x80;
+    xor_blk(b, b, ctx->K2);
+  }
+}
+
+/* Batched CMAC of N items. CMAC is serial within message, so each parallel
+ * block lane is assigned its own item and lanes are refilled with next
+ * items as items finish. */
+static void cmac_items(struct camellia_cmac_ctx *ctx,
+		       const struct cmac_item *items, size_t n,
+		       unsigned int nlanes, blks_crypt_fn_t encrypt)
+{
+  const struct cmac_item *lanes[32];
+  size_t pos[32];
+  uint8_t blks[32 * 16];
+  uint8_t b[16];
+  unsigned int nactive = 0;
+  unsigned int i;
+
+  memset(lanes, 0, sizeof(lanes));
+  memset(blks, 0, sizeof(blks));
+
+  while (1) {
+    /* Refill empty lanes, chaining value starts from zero. */
+    for (i = 0; i < nlanes && n; i++) {
+      if (lanes[i])
+	continue;
+
+      lanes[i] = items++;
+      pos[i] = 0;
+      memset(&blks[i * 16], 0, 16);
+      n--;
+      nactive++;
+    }
+
+    if (!nactive)
+      break;
+
+    /* Gather next block of each lane XORed with chaining value. Inactive
+     * lanes are left as is and their output is discarded. */
+    for (i = 0; i < nlanes; i++) {
+      if (!lanes[i])
+	continue;
+
+      cmac_item_blk(ctx, lanes[i], pos[i], b);
+      xor_blk(&blks[i * 16], &blks[i * 16], b);
+    }
+
+    encrypt(&ctx->cipher, blks, blks);
+
+    /* Store MACs and retire finished items. */
+    for (i = 0; i < nlanes; i++) {
+      if (!lanes[i])
+	continue;
+
+      pos[i] += 16;
+      if (pos[i] < lanes[i]->len)
+	continue;
+
+      memcpy(lanes[i]->mac, &blks[i * 16], 16);
+      lanes[i] = NULL;
+      nactive--;
+    }
+  }
+
+  wipe_memory(blks, sizeof(blks));
+  wipe_memory(b, sizeof(b));
+}
+
+/* Batched CMAC of messages, 64 messages per cmac_items call. Generation
+ * writes tags to TAGS, verification compares against CHECK_TAGS in
+ * constant time, sets STATUS of each message (if non-NULL) and returns -1
+ * if any tag does not match. */
+static int cmac_multi(struct camellia_cmac_ctx *ctx, const void *const *msgs,
+		      const size_t *lens, uint8_t *tags,
+		      const uint8_t *check_tags, int *status, size_t n,
+		      unsigned int nlanes, blks_crypt_fn_t encrypt)
+{
+  struct cmac_item items[64];
+  uint8_t macs[64][16];
+  size_t i, j, cnt;
+  int ret = 0;
+  int st;
+
+  for (i = 0; i < n; i += cnt) {
+    cnt = n - i < 64 ? n - i : 64;
+
+    for (j = 0; j < cnt; j++) {
+      items[j].msg = msgs[i + j];
+      items[j].len = lens[i + j];
+      items[j].xorend = NULL;
+      items[j].mac = check_tags ? macs[j] : &tags[(i + j) * 16];
+    }
+
+    cmac_items(ctx, items, cnt, nlanes, encrypt);
+
+    if (!check_tags)
+      continue;
+
+    for (j = 0; j < cnt; j++) {
+      st = check_tag(macs[j], &check_tags[(i + j) * 16], 16);
+      if (status)
+	status[i + j] = st;
+      ret |= st;
+    }
+  }
+
+  wipe_memory(macs, sizeof(macs));
+
+  return ret;
+}
+
+void camellia_cmac_batch_simd128(struct camellia_cmac_ctx *ctx,
+				 const void *const *msgs, const size_t *lens,
+				 void *tags, size_t n)
+{
+  cmac_multi(ctx, msgs, lens, tags, NULL, NULL, n, 16,
+	     camellia_encrypt_16blks_simd128);
+}
+
+int camellia_cmac_verify_batch_simd128(struct camellia_cmac_ctx *ctx,
+				       const void *const *msgs,
+				       const size_t *lens, const void *tags,
+				       size_t n, int *status)
+{
+  return cmac_multi(ctx, msgs, lens, NULL, tags, status, n, 16,
+		    camellia_encrypt_16blks_simd128);
+}
+
+int camellia_siv_keysetup_simd128(struct camellia_siv_ctx *ctx,
+				  const void *key, unsigned int keylen)
+{
+  static const uint8_t zero[16];
+  struct cmac_item item;
+
+  if (keylen != 32 && keylen != 48 && keylen != 64)
+    return -1;
+
+  camellia_cmac_keysetup_simd128(&ctx->mac, key, keylen / 2);
+  camellia_keysetup_simd128(&ctx->ctr, (const uint8_t *)key + keylen / 2,
+			    keylen / 2);
+
+  item.msg = zero;
+  item.len = 16;
+  item.xorend = NULL;
+  item.mac = ctx->D0;
+  cmac_items(&ctx->mac, &item, 1, 16, camellia_encrypt_16blks_simd128);
+
+  return 0;
+}
+
+/* S2V of up to 32 messages to V. CMACs of associated data components of all
+ * messages are computed in parallel and folded to D of each message in
+ * component order, then CMACs of final strings of all messages are computed
+ * in parallel. Final string is plaintext, from IN for encryption and from
+ * OUT for decryption. */
+static void siv_s2v(struct camellia_siv_ctx *ctx,
+		    const struct camellia_siv_msg *msgs, unsigned int nmsgs,
+		    int decrypt, uint8_t (*V)[16], unsigned int nlanes,
+		    blks_crypt_fn_t encrypt)
+{
+  struct cmac_item items[64];
+  uint8_t macs[64][16];
+  unsigned int owner[64];
+  uint8_t D[32][16];
+  uint8_t T[32][16];
+  unsigned int nitems = 0;
+  unsigned int i, j;
+  size_t k;
+
+  for (i = 0; i < nmsgs; i++)
+    memcpy(D[i], ctx->D0, 16);
+
+  /* D = dbl(D) XOR CMAC(S_k) for associated data components. */
+  for (i = 0; i < nmsgs; i++) {
+    for (k = 0; k < msgs[i].nad; k++) {
+      items[nitems].msg = msgs[i].ad[k];
+      items[nitems].len = msgs[i].adlens[k];
+      items[nitems].xorend = NULL;
+      items[nitems].mac = macs[nitems];
+      owner[nitems] = i;
+
+      if (++nitems < 64)
+	continue;
+
+      cmac_items(&ctx->mac, items, nitems, nlanes, encrypt);
+      for (j = 0; j < nitems; j++) {
+	ocb_double(D[owner[j]], D[owner[j]]);
+	xor_blk(D[owner[j]], D[owner[j]], macs[j]);
+      }
+      nitems = 0;
+    }
+  }
+  if (nitems) {
+    cmac_items(&ctx->mac, items, nitems, nlanes, encrypt);
+    for (j = 0; j < nitems; j++) {
+      ocb_double(D[owner[j]], D[owner[j]]);
+      xor_blk(D[owner[j]], D[owner[j]], macs[j]);
+    }
+  }
+
+  /* V = CMAC(S_n xorend D) or CMAC(dbl(D) XOR pad(S_n)). */
+  for (i = 0; i < nmsgs; i++) {
+    const uint8_t *sn = decrypt ? msgs[i].out : msgs[i].in;
+    size_t len = msgs[i].nbytes;
+
+    items[i].mac = V[i];
+    if (len >= 16) {
+      items[i].msg = sn;
+      items[i].len = len;
+      items[i].xorend = D[i];
+    } else {
+      memset(T[i], 0, 16);
+      memcpy(T[i], sn, len);
+      T[i][len] = 0x80;
+      ocb_double(D[i], D[i]);
+      xor_blk(T[i], T[i], D[i]);
+      items[i].msg = T[i];
+      items[i].len = 16;
+      items[i].xorend = NULL;
+    }
+  }
+  cmac_items(&ctx->mac, items, nmsgs, nlanes, encrypt);
+
+  wipe_memory(macs, sizeof(macs));
+  wipe_memory(D, sizeof(D));
+  wipe_memory(T, sizeof(T));
+}
+
+/* CTR encryption of all messages with counter Q = V with bits 63 and 31
+ * cleared. */
+static void siv_ctr_multi(struct camellia_siv_ctx *ctx,
+			  struct camellia_siv_msg *msgs, size_t nmsgs,
+			  unsigned int nlanes, blks_crypt_fn_t encrypt,
+			  blks_crypt_iv_fn_t ctr_enc)
+{
+  struct ks_batch b;
+  uint8_t ctr[16];
+  size_t i;
+
+  b.n = 0;
+  for (i = 0; i < nmsgs; i++) {
+    memcpy(ctr, msgs[i].iv, 16);
+    ctr[8] &= 0x7f;
+    ctr[12] &= 0x7f;
+    ks_ctr(&ctx->ctr, &b, msgs[i].out, msgs[i].in, msgs[i].nbytes, ctr,
+	   nlanes, encrypt, ctr_enc);
+  }
+  ks_flush(&ctx->ctr, &b, encrypt);
+
+  wipe_memory(b.blks, sizeof(b.blks));
+  wipe_memory(ctr, sizeof(ctr));
+}
+
+/* Multi-message SIV. Encryption computes S2V of plaintext before CTR
+ * encryption, decryption computes S2V of plaintext after CTR decryption,
+ * so messages may be processed in-place. */
+static int siv_crypt_multi(struct camellia_siv_ctx *ctx,
+			   struct camellia_siv_msg *msgs, size_t nmsgs,
+			   int decrypt, unsigned int nlanes,
+			   blks_crypt_fn_t encrypt, blks_crypt_iv_fn_t ctr_enc)
+{
+  uint8_t V[32][16];
+  size_t i, j, cnt;
+  int ret = 0;
+
+  if (decrypt)
+    siv_ctr_multi(ctx, msgs, nmsgs, nlanes, encrypt, ctr_enc);
+
+  for (i = 0; i < nmsgs; i += cnt) {
+    cnt = nmsgs - i < 32 ? nmsgs - i : 32;
+
+    siv_s2v(ctx, &msgs[i], cnt, decrypt, V, nlanes, encrypt);
+
+    for (j = 0; j < cnt; j++) {
+      if (decrypt) {
+	msgs[i + j].status = check_tag(V[j], msgs[i + j].iv, 16);
+	ret |= msgs[i + j].status;
+      } else {
+	memcpy(msgs[i + j].iv, V[j], 16);
+	msgs[i + j].status = 0;
+      }
+    }
+  }
+
+  if (!decrypt)
+    siv_ctr_multi(ctx, msgs, nmsgs, nlanes, encrypt, ctr_enc);
+
+  wipe_memory(V, sizeof(V));
+
+  return ret;
+}
+
+void camellia_siv_encrypt_multi_simd128(struct camellia_siv_ctx *ctx,
+					struct camellia_siv_msg *msgs,
+					size_t nmsgs)
+{
+  siv_crypt_multi(ctx, msgs, nmsgs, 0, 16, camellia_encrypt_16blks_simd128,
+		  camellia_ctr_enc_16blks_simd128);
+}
+
+int camellia_siv_decrypt_multi_simd128(struct camellia_siv_ctx *ctx,
+				       struct camellia_siv_msg *msgs,
+				       size_t nmsgs)
+{
+  return siv_crypt_multi(ctx, msgs, nmsgs, 1, 16,
+			 camellia_encrypt_16blks_simd128,
+			 camellia_ctr_enc_16blks_simd128);
+}
+
+/* XORs 64-bit big-endian key wrap step counter T to A. */
+static void keywrap_xor_t(uint8_t *a, uint64_t t)
+{
+  int i;
+
+  for (i = 7; i >= 0; i--, t >>= 8)
+    a[i] ^= t & 0xff;
+}
+
+/* Key wrap lane. Integrity register A is kept in first half of lane's
+ * block, R points to 64-bit registers R[1..N] in output buffer and STEP is
+ * index of current wrap step, t - 1. */
+struct keywrap_lane
+{
+  struct camellia_keywrap_key *key;
+  uint8_t *R;
+  size_t n;
+  size_t step;
+};
+
+/* Batched key wrap (RFC 3394). Wrap step t (1 to 6N) encrypts A || R[i]
+ * with i = (t - 1) mod N + 1 and sets A = MSB(B) XOR t, R[i] = LSB(B).
+ * Unwrap runs steps from 6N to 1 with decryption of (A XOR t) || R[i]. */
+static int keywrap_multi(struct camellia_simd_ctx *ctx,
+			 struct camellia_keywrap_key *keys, size_t nkeys,
+			 int unwrap, unsigned int nlanes,
+			 blks_crypt_fn_t crypt)
+{
+  static const uint8_t iv[8] = {
+    0xa6, 0xa6, 0xa6, 0xa6, 0xa6, 0xa6, 0xa6, 0xa6
+  };
+  struct keywrap_lane lanes[32];
+  uint8_t blks[32 * 16];
+  unsigned int nactive = 0;
+  unsigned int i;
+  int ret = 0;
+
+  memset(blks, 0, sizeof(blks));
+  for (i = 0; i < nlanes; i++)
+    lanes[i].key = NULL;
+
+  while (1) {
+    /* Refill empty lanes. Key data is moved to its place in output
+     * buffer first, so IN and OUT may overlap. */
+    for (i = 0; i < nlanes && nkeys; i++) {
+      struct keywrap_lane *lane = &lanes[i];
+      struct camellia_keywrap_key *key;
+
+      if (lane->key)
+	continue;
+
+      /* Keys with invalid key data length are rejected without
+       * processing. */
+      while (nkeys && (keys->nbytes < 16 || keys->nbytes % 8 != 0)) {
+	keys->status = -1;
+	ret = -1;
+	keys++;
+	nkeys--;
+      }
+      if (!nkeys)
+	break;
+
+      key = keys++;
+      nkeys--;
+      lane->key = key;
+      lane->n = key->nbytes / 8;
+      if (unwrap) {
+	memcpy(&blks[i * 16], key->in, 8);
+	memmove(key->out, (const uint8_t *)key->in + 8, key->nbytes);
+	lane->R = key->out;
+	lane->step = 6 * lane->n - 1;
+      } else {
+	memmove((uint8_t *)key->out + 8, key->in, key->nbytes);
+	memcpy(&blks[i * 16], iv, 8);
+	lane->R = (uint8_t *)key->out + 8;
+	lane->step = 0;
+      }
+      nactive++;
+    }
+
+    if (!nactive)
+      break;
+
+    /* Gather R[i] of each lane next to A. Inactive lanes are left as is and
+     * their output is discarded. */
+    for (i = 0; i < nlanes; i++) {
+      struct keywrap_lane *lane = &lanes[i];
+
+      if (!lane->key)
+	continue;
+
+      if (unwrap)
+	keywrap_xor_t(&blks[i * 16], lane->step + 1);
+      memcpy(&blks[i * 16 + 8], lane->R + (lane->step % lane->n) * 8, 8);
+    }
+
+    crypt(ctx, blks, blks);
+
+    /* Scatter R[i] and retire finished keys. */
+    for (i = 0; i < nlanes; i++) {
+      struct keywrap_lane *lane = &lanes[i];
+      struct camellia_keywrap_key *key = lane->key;
+
+      if (!key)
+	continue;
+
+      memcpy(lane->R + (lane->step % lane->n) * 8, &blks[i * 16 + 8], 8);
+
+      if (!unwrap) {
+	keywrap_xor_t(&blks[i * 16], lane->step + 1);
+	if (++lane->step < 6 * lane->n)
+	  continue;
+
+	memcpy(key->out, &blks[i * 16], 8);
+	key->status = 0;
+      } else {
+	if (lane->step-- > 0)
+	  continue;
+
+	key->status = check_tag(&blks[i * 16], iv, 8);
+	if (key->status)
+	  wipe_memory(key->out, key->nbytes);
+	ret |= key->status;
+      }
+
+      lane->key = NULL;
+      nactive--;
+    }
+  }
+
+  wipe_memory(blks, sizeof(blks));
+
+  return ret;
+}
+
+void camellia_keywrap_batch_simd128(struct camellia_simd_ctx *ctx,
+				    struct camellia_keywrap_key *keys,
+				    size_t nkeys)
+{
+  keywrap_multi(ctx, keys, nkeys, 0, 16, camellia_encrypt_16blks_simd128);
+}
+
+int camellia_keyunwrap_batch_simd128(struct camellia_simd_ctx *ctx,
+				     struct camellia_keywrap_key *keys,
+				     size_t nkeys)
+{
+  return keywrap_multi(ctx, keys, nkeys, 1, 16,
+		       camellia_decrypt_16blks_simd128);
+}
+
+#ifdef USE_SIMD256
+void camellia_encrypt_blocks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks)
+{
+  ecb_crypt(ctx, out, in, nblocks, 32, camellia_encrypt_32blks_simd256,
+	    camellia_encrypt_nblks_simd256);
+}
+
+void camellia_decrypt_blocks_simd256(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks)
+{
+  ecb_crypt(ctx, out, in, nblocks, 32, camellia_decrypt_32blks_simd256,
+	    camellia_decrypt_nblks_simd256);
+}
+
+void camellia_ctr_encrypt_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				  const void *vin, size_t nbytes, void *viv)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  uint8_t *iv = viv;
+
+  while (nbytes >= 32 * 16) {
+    camellia_ctr_enc_32blks_simd256(ctx, out, in, iv);
+    out += 32 * 16;
+    in += 32 * 16;
+    nbytes -= 32 * 16;
+  }
+
+  camellia_ctr_encrypt_simd128(ctx, out, in, nbytes, iv);
+}
+
+int camellia_cbc_decrypt_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				 const void *vin, size_t nbytes, void *viv)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  uint8_t *iv = viv;
+
+  if (nbytes % 16 != 0)
+    return -1;
+
+  while (nbytes >= 32 * 16) {
+    camellia_cbc_dec_32blks_simd256(ctx, out, in, iv);
+    out += 32 * 16;
+    in += 32 * 16;
+    nbytes -= 32 * 16;
+  }
+
+  return camellia_cbc_decrypt_simd128(ctx, out, in, nbytes, iv);
+}
+
+void camellia_cfb_decrypt_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				  const void *vin, size_t nbytes, void *viv)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  uint8_t *iv = viv;
+
+  while (nbytes >= 32 * 16) {
+    camellia_cfb_dec_32blks_simd256(ctx, out, in, iv);
+    out += 32 * 16;
+    in += 32 * 16;
+    nbytes -= 32 * 16;
+  }
+
+  camellia_cfb_decrypt_simd128(ctx, out, in, nbytes, iv);
+}
+
+void camellia_xts_encrypt_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				  const void *vin, size_t nbytes, void *tweak)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  /* Ciphertext stealing is done by SIMD128 implementation and needs last
+   * full block. */
+  size_t tail = (nbytes % 16) ? 16 + nbytes % 16 : 0;
+
+  while (nbytes >= tail + 32 * 16) {
+    camellia_xts_enc_32blks_simd256(ctx, out, in, tweak);
+    out += 32 * 16;
+    in += 32 * 16;
+    nbytes -= 32 * 16;
+  }
+
+  camellia_xts_encrypt_simd128(ctx, out, in, nbytes, tweak);
+}
+
+void camellia_xts_decrypt_simd256(struct camellia_simd_ctx *ctx, void *vout,
+				  const void *vin, size_t nbytes, void *tweak)
+{
+  uint8_t *out = vout;
+  const uint8_t *in = vin;
+  /* Ciphertext stealing is done by SIMD128 implementation and needs last
+   * full block. */
+  size_t tail = (nbytes % 16) ? 16 + nbytes % 16 : 0;
+
+  while (nbytes >= tail + 32 * 16) {
+    camellia_xts_dec_32blks_simd256(ctx, out, in, tweak);
+    out += 32 * 16;
+    in += 32 * 16;
+    nbytes -= 32 * 16;
+  }
+
+  camellia_xts_decrypt_simd128(ctx, out, in, nbytes, tweak);
+}
+
+void camellia_cbc_encrypt_multi_simd256(struct camellia_simd_ctx *ctx,
+					struct camellia_cbc_stream *streams,
+					size_t nstreams)
+{
+  cbc_enc_multi(ctx, streams, nstreams, 32, camellia_encrypt_32blks_simd256);
+}
+
+void camellia_ocb_encrypt_simd256(struct camellia_ocb_ctx *ctx, void *out,
+				  const void *in, size_t nbytes,
+				  const void *nonce, size_t noncelen,
+				  const void *ad, size_t adlen, void *tag)
+{
+  ocb_crypt(ctx, out, in, nbytes, nonce, noncelen, ad, adlen, tag, 0, 32,
+	    camellia_encrypt_32blks_simd256, camellia_ocb_enc_32blks_simd256,
+	    camellia_ocb_enc_16blks_simd128);
+}
+
+int camellia_ocb_decrypt_simd256(struct camellia_ocb_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *nonce, size_t noncelen,
+				 const void *ad, size_t adlen, const void *tag)
+{
+  uint8_t t[16];
+
+  ocb_crypt(ctx, out, in, nbytes, nonce, noncelen, ad, adlen, t, 1, 32,
+	    camellia_encrypt_32blks_simd256, camellia_ocb_dec_32blks_simd256,
+	    camellia_ocb_dec_16blks_simd128);
+
+  return check_tag(t, tag, 16);
+}
+
+void camellia_gcm_encrypt_simd256(struct camellia_gcm_ctx *ctx, void *out,
+				  const void *in, size_t nbytes,
+				  const void *iv, size_t ivlen,
+				  const void *ad, size_t adlen, void *tag)
+{
+  gcm_crypt(ctx, out, in, nbytes, iv, ivlen, ad, adlen, tag, 0, 32,
+	    camellia_encrypt_32blks_simd256, camellia_ctr_enc_32blks_simd256,
+	    camellia_gcm_32blks_simd256, camellia_ghash_simd256);
+}
+
+int camellia_gcm_decrypt_simd256(struct camellia_gcm_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *iv, size_t ivlen,
+				 const void *ad, size_t adlen, const void *tag)
+{
+  uint8_t t[16];
+
+  gcm_crypt(ctx, out, in, nbytes, iv, ivlen, ad, adlen, t, 1, 32,
+	    camellia_encrypt_32blks_simd256, camellia_ctr_enc_32blks_simd256,
+	    camellia_gcm_32blks_simd256, camellia_ghash_simd256);
+
+  return check_tag(t, tag, 16);
+}
+
+void camellia_gcm_siv_encrypt_simd256(struct camellia_gcm_siv_ctx *ctx,
+				      void *out, const void *in, size_t nbytes,
+				      const void *nonce, const void *ad,
+				      size_t adlen, void *tag)
+{
+  gcm_siv_crypt(ctx, out, in, nbytes, nonce, ad, adlen, tag, 0, 32,
+		camellia_encrypt_32blks_simd256, camellia_polyval_simd256);
+}
+
+int camellia_gcm_siv_decrypt_simd256(struct camellia_gcm_siv_ctx *ctx,
+				     void *out, const void *in, size_t nbytes,
+				     const void *nonce, const void *ad,
+				     size_t adlen, const void *tag)
+{
+  uint8_t t[16];
+
+  memcpy(t, tag, 16);
+  gcm_siv_crypt(ctx, out, in, nbytes, nonce, ad, adlen, t, 1, 32,
+		camellia_encrypt_32blks_simd256, camellia_polyval_simd256);
+
+  return check_tag(t, tag, 16);
+}
+
+void camellia_ccm_encrypt_multi_simd256(struct camellia_simd_ctx *ctx,
+					struct camellia_ccm_msg *msgs,
+					size_t nmsgs)
+{
+  ccm_crypt_multi(ctx, msgs, nmsgs, 0, 32, camellia_encrypt_32blks_simd256,
+		  camellia_ctr_enc_32blks_simd256);
+}
+
+int camellia_ccm_decrypt_multi_simd256(struct camellia_simd_ctx *ctx,
+				       struct camellia_ccm_msg *msgs,
+				       size_t nmsgs)
+{
+  return ccm_crypt_multi(ctx, msgs, nmsgs, 1, 32,
+			 camellia_encrypt_32blks_simd256,
+			 camellia_ctr_enc_32blks_simd256);
+}
+
+void camellia_cmac_batch_simd256(struct camellia_cmac_ctx *ctx,
+				 const void *const *msgs, const size_t *lens,
+				 void *tags, size_t n)
+{
+  cmac_multi(ctx, msgs, lens, tags, NULL, NULL, n, 32,
+	     camellia_encrypt_32blks_simd256);
+}
+
+int camellia_cmac_verify_batch_simd256(struct camellia_cmac_ctx *ctx,
+				       const void *const *msgs,
+				       const size_t *lens, const void *tags,
+				       size_t n, int *status)
+{
+  return cmac_multi(ctx, msgs, lens, NULL, tags, status, n, 32,
+		    camellia_encrypt_32blks_simd256);
+}
+
+void camellia_siv_encrypt_multi_simd256(struct camellia_siv_ctx *ctx,
+					struct camellia_siv_msg *msgs,
+					size_t nmsgs)
+{
+  siv_crypt_multi(ctx, msgs, nmsgs, 0, 32, camellia_encrypt_32blks_simd256,
+		  camellia_ctr_enc_32blks_simd256);
+}
+
+int camellia_siv_decrypt_multi_simd256(struct camellia_siv_ctx *ctx,
+				       struct camellia_siv_msg *msgs,
+				       size_t nmsgs)
+{
+  return siv_crypt_multi(ctx, msgs, nmsgs, 1, 32,
+			 camellia_encrypt_32blks_simd256,
+			 camellia_ctr_enc_32blks_simd256);
+}
+
+void camellia_keywrap_batch_simd256(struct camellia_simd_ctx *ctx,
+				    struct camellia_keywrap_key *keys,
+				    size_t nkeys)
+{
+  keywrap_multi(ctx, keys, nkeys, 0, 32, camellia_encrypt_32blks_simd256);
+}
+
+int camellia_keyunwrap_batch_simd256(struct camellia_simd_ctx *ctx,
+				     struct camellia_keywrap_key *keys,
+				     size_t nkeys)
+{
+  return keywrap_multi(ctx, keys, nkeys, 1, 32,
+		       camellia_decrypt_32blks_simd256);
+}
+#endif
+
+#ifdef USE_SIMD512
+/* Processes full batches of 64 blocks with CRYPT64, remaining batches of 32
+ * and 16 blocks with CRYPT32 and CRYPT16, and final 1 to 15 blocks with
+ * partial batch implementation CRYPT_N. */
+static void ecb_crypt_simd512(struct camellia_simd_ctx *ctx, uint8_t *out,
+			      const uint8_t *in, size_t nblocks,
+			      blks_crypt_fn_t crypt64, blks_crypt_fn_t crypt32,
+			      blks_crypt_fn_t crypt16, nblks_crypt_fn_t crypt_n)
+{
+  while (nblocks >= 64) {
+    crypt64(ctx, out, in);
+    out += 64 * 16;
+    in += 64 * 16;
+    nblocks -= 64;
+  }
+
+  if (nblocks >= 32) {
+    crypt32(ctx, out, in);
+    out += 32 * 16;
+    in += 32 * 16;
+    nblocks -= 32;
+  }
+
+  if (nblocks >= 16) {
+    crypt16(ctx, out, in);
+    out += 16 * 16;
+    in += 16 * 16;
+    nblocks -= 16;
+  }
+
+  if (nblocks)
+    crypt_n(ctx, out, in, nblocks);
+}
+
+void camellia_encrypt_blocks_simd512(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks)
+{
+  ecb_crypt_simd512(ctx, out, in, nblocks, camellia_encrypt_64blks_simd512,
+		    camellia_encrypt_32blks_simd256,
+		    camellia_encrypt_16blks_simd128,
+		    camellia_encrypt_nblks_simd128);
+}
+
+void camellia_decrypt_blocks_simd512(struct camellia_simd_ctx *ctx, void *out,
+				     const void *in, size_t nblocks)
+{
+  ecb_crypt_simd512(ctx, out, in, nblocks, camellia_decrypt_64blks_simd512,
+		    camellia_decrypt_32blks_simd256,
+		    camellia_decrypt_16blks_simd128,
+		    camellia_decrypt_nblks_simd128);
+}
+#endif
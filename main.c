@@ -124,272 +124,3025 @@ static __attribute__((unused)) const char *blk2str(const uint8_t *blk)
   return buf;
 }
 
-static void do_selftest(void)
+static void ctr_add_ref(uint8_t *ctr, unsigned int nblks)
+{
+  while (nblks) {
+    int i = 15;
+    while (i >= 0 && ++ctr[i] == 0)
+      i--;
+    nblks--;
+  }
+}
+
+static void Camellia_ctr_encrypt(const void *src, void *dst, size_t nbytes,
+				 uint8_t *iv, CAMELLIA_KEY *ctx)
+{
+  const uint8_t *in = src;
+  uint8_t *out = dst;
+  uint8_t ks[16];
+  size_t i;
+
+  while (nbytes) {
+    size_t n = nbytes < 16 ? nbytes : 16;
+
+    Camellia_encrypt(iv, ks, ctx);
+    ctr_add_ref(iv, 1);
+    for (i = 0; i < n; i++)
+      out[i] = in[i] ^ ks[i];
+    out += n;
+    in += n;
+    nbytes -= n;
+  }
+}
+
+typedef void (*blks_crypt_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+				const void *in);
+
+static void selftest_blks1_4(const uint8_t *key, int nbits)
 {
+  static const struct {
+    unsigned int nblks;
+    blks_crypt_fn_t encrypt;
+    blks_crypt_fn_t decrypt;
+  } fns[] = {
+    { 1, camellia_encrypt_1blk_simd128, camellia_decrypt_1blk_simd128 },
+    { 2, camellia_encrypt_2blks_simd128, camellia_decrypt_2blks_simd128 },
+    { 4, camellia_encrypt_4blks_simd128, camellia_decrypt_4blks_simd128 },
+  };
   struct camellia_simd_ctx ctx_simd;
   CAMELLIA_KEY ctx_ref = { 0 };
-  uint8_t key[32];
-  uint8_t tmp[32 * 16];
-  uint8_t plaintext_simd[32 * 16];
-  uint8_t ref_large_plaintext[32 * 16];
-  uint8_t ref_large_ciphertext_128[32 * 16];
-  uint8_t ref_large_ciphertext_256[32 * 16];
+  uint8_t src[5 * 16];
+  uint8_t dst[5 * 16];
+  uint8_t ref[5 * 16];
+  unsigned int i, j, n;
+
+  printf("selftest: checking 1/2/4-block camellia-%d/SIMD128 against reference implementation...\n",
+	 nbits);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < sizeof(fns) / sizeof(fns[0]); i++) {
+    n = fns[i].nblks;
+
+    for (j = 0; j < sizeof(src); j++)
+      src[j] = ((j + 3221) * 1231) & 0xff;
+
+    /* Output is chained to next input, so that varied block contents are
+     * checked. Bytes past N blocks must be left untouched. */
+    for (j = 0; j < 64; j++) {
+      memset(ref, 0xaa, sizeof(ref));
+      for (n = 0; n < fns[i].nblks; n++)
+	Camellia_encrypt(&src[n * 16], &ref[n * 16], &ctx_ref);
+
+      /* Out-of-place. */
+      memset(dst, 0xaa, sizeof(dst));
+      fns[i].encrypt(&ctx_simd, dst, src);
+      assert(memcmp(dst, ref, sizeof(ref)) == 0);
+
+      memset(dst, 0xaa, sizeof(dst));
+      fns[i].decrypt(&ctx_simd, dst, ref);
+      assert(memcmp(dst, src, n * 16) == 0);
+      assert(dst[n * 16] == 0xaa);
+
+      /* In-place. */
+      fns[i].encrypt(&ctx_simd, dst, dst);
+      assert(memcmp(dst, ref, n * 16) == 0);
+      fns[i].decrypt(&ctx_simd, dst, dst);
+      assert(memcmp(dst, src, n * 16) == 0);
+
+      memcpy(src, ref, n * 16);
+    }
+  }
+}
+
+typedef void (*blocks_crypt_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+				  const void *in, size_t nblocks);
+
+static void selftest_ecb_blocks(const char *variant,
+				blocks_crypt_fn_t encrypt_blocks,
+				blocks_crypt_fn_t decrypt_blocks,
+				const uint8_t *key, int nbits)
+{
+  struct camellia_simd_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  uint8_t src[128 * 16];
+  uint8_t dst[128 * 16];
+  uint8_t ref[128 * 16];
+  size_t nblocks;
+  unsigned int i;
+
+  printf("selftest: checking ECB mode camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < sizeof(src); i++)
+    src[i] = ((i + 3221) * 1231) & 0xff;
+
+  /* Every length from 0 to 127 blocks, so that each width of parallel
+   * implementation and each partial batch length is used. Bytes past
+   * NBLOCKS must be left untouched. */
+  for (nblocks = 0; nblocks < sizeof(src) / 16; nblocks++) {
+    memset(ref, 0xaa, sizeof(ref));
+    for (i = 0; i < nblocks; i++)
+      Camellia_encrypt(&src[i * 16], &ref[i * 16], &ctx_ref);
+
+    /* Out-of-place. */
+    memset(dst, 0xaa, sizeof(dst));
+    encrypt_blocks(&ctx_simd, dst, src, nblocks);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+
+    /* In-place. */
+    memcpy(dst, src, sizeof(dst));
+    memcpy(&ref[nblocks * 16], &src[nblocks * 16],
+	   sizeof(ref) - nblocks * 16);
+    encrypt_blocks(&ctx_simd, dst, dst, nblocks);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+
+    decrypt_blocks(&ctx_simd, dst, dst, nblocks);
+    assert(memcmp(dst, src, sizeof(src)) == 0);
+
+    /* Decryption out-of-place. */
+    memset(dst, 0xaa, sizeof(dst));
+    decrypt_blocks(&ctx_simd, dst, ref, nblocks);
+    assert(memcmp(dst, src, nblocks * 16) == 0);
+    for (i = nblocks * 16; i < sizeof(dst); i++)
+      assert(dst[i] == 0xaa);
+  }
+}
+
+typedef void (*mode_crypt_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+				const void *in, size_t nbytes, void *iv);
+
+static void selftest_ctr(const char *variant, mode_crypt_fn_t ctr_encrypt,
+			 const uint8_t *key, int nbits)
+{
+  static const size_t lengths[] = {
+    0, 1, 15, 16, 17, 16 * 16 - 1, 16 * 16, 16 * 16 + 1, 32 * 16 - 1,
+    32 * 16, 32 * 16 + 15, 64 * 16, 64 * 16 + 7, 99 * 16 + 3
+  };
+  static const uint8_t ivs[][16] = {
+    { 0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+      0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x00 },
+    { 0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+      0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0xf5 },
+    { 0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+      0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xe9 },
+    { 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,
+      0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xfe },
+  };
+  struct camellia_simd_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  uint8_t src[100 * 16];
+  uint8_t dst[100 * 16];
+  uint8_t ref[100 * 16];
+  uint8_t iv_simd[16];
+  uint8_t iv_ref[16];
   unsigned int i, j;
 
-  /* Check test vectors against reference implementation. */
-  printf("selftest: comparing camellia-%d test vectors against reference implementation...\n", 128);
-  Camellia_set_key(test_vector_key_128, 128, &ctx_ref);
-  Camellia_encrypt(test_vector_plaintext, tmp, &ctx_ref);
-  assert(memcmp(tmp, test_vector_ciphertext_128, 16) == 0);
-  Camellia_decrypt(tmp, tmp, &ctx_ref);
-  assert(memcmp(tmp, test_vector_plaintext, 16) == 0);
+  printf("selftest: checking CTR mode camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < sizeof(src); i++)
+    src[i] = ((i + 3221) * 1231) & 0xff;
+
+  for (i = 0; i < sizeof(ivs) / sizeof(ivs[0]); i++) {
+    for (j = 0; j < sizeof(lengths) / sizeof(lengths[0]); j++) {
+      memcpy(iv_ref, ivs[i], 16);
+      memset(ref, 0xaa, sizeof(ref));
+      Camellia_ctr_encrypt(src, ref, lengths[j], iv_ref, &ctx_ref);
+
+      /* Out-of-place. */
+      memcpy(iv_simd, ivs[i], 16);
+      memset(dst, 0xaa, sizeof(dst));
+      ctr_encrypt(&ctx_simd, dst, src, lengths[j], iv_simd);
+      assert(memcmp(dst, ref, sizeof(ref)) == 0);
+      assert(memcmp(iv_simd, iv_ref, 16) == 0);
+
+      /* In-place. */
+      memcpy(iv_simd, ivs[i], 16);
+      memcpy(dst, src, sizeof(dst));
+      memcpy(&ref[lengths[j]], &src[lengths[j]], sizeof(ref) - lengths[j]);
+      ctr_encrypt(&ctx_simd, dst, dst, lengths[j], iv_simd);
+      assert(memcmp(dst, ref, sizeof(ref)) == 0);
+      assert(memcmp(iv_simd, iv_ref, 16) == 0);
+    }
+  }
+}
 
-  printf("selftest: comparing camellia-%d test vectors against reference implementation...\n", 192);
-  Camellia_set_key(test_vector_key_192, 192, &ctx_ref);
-  Camellia_encrypt(test_vector_plaintext, tmp, &ctx_ref);
-  assert(memcmp(tmp, test_vector_ciphertext_192, 16) == 0);
-  Camellia_decrypt(tmp, tmp, &ctx_ref);
-  assert(memcmp(tmp, test_vector_plaintext, 16) == 0);
+static void Camellia_cbc_decrypt(const void *src, void *dst, size_t nbytes,
+				 uint8_t *iv, CAMELLIA_KEY *ctx)
+{
+  const uint8_t *in = src;
+  uint8_t *out = dst;
+  uint8_t ct[16];
+  size_t i;
+
+  for (; nbytes >= 16; nbytes -= 16) {
+    memcpy(ct, in, 16);
+    Camellia_decrypt(in, out, ctx);
+    for (i = 0; i < 16; i++)
+      out[i] ^= iv[i];
+    memcpy(iv, ct, 16);
+    out += 16;
+    in += 16;
+  }
+}
 
-  printf("selftest: comparing camellia-%d test vectors against reference implementation...\n", 256);
-  Camellia_set_key(test_vector_key_256, 256, &ctx_ref);
-  Camellia_encrypt(test_vector_plaintext, tmp, &ctx_ref);
-  assert(memcmp(tmp, test_vector_ciphertext_256, 16) == 0);
-  Camellia_decrypt(tmp, tmp, &ctx_ref);
-  assert(memcmp(tmp, test_vector_plaintext, 16) == 0);
+typedef int (*cbc_decrypt_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+				const void *in, size_t nbytes, void *iv);
 
-  /* Check 16-block SIMD128 implementation against known test vectors. */
-  printf("selftest: checking 16-block parallel camellia-128/SIMD128 against test vectors...\n");
-  fill_blks(plaintext_simd, test_vector_plaintext, 16);
+static void selftest_cbc_dec(const char *variant, cbc_decrypt_fn_t cbc_decrypt,
+			     const uint8_t *key, int nbits)
+{
+  static const size_t lengths[] = {
+    0, 16, 15 * 16, 16 * 16, 17 * 16, 31 * 16, 32 * 16, 33 * 16, 48 * 16,
+    64 * 16, 99 * 16
+  };
+  static const size_t bad_lengths[] = { 1, 15, 17, 16 * 16 + 8, 33 * 16 - 1 };
+  static const uint8_t iv[16] = {
+    0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+    0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10
+  };
+  struct camellia_simd_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  uint8_t src[100 * 16];
+  uint8_t dst[100 * 16];
+  uint8_t ref[100 * 16];
+  uint8_t iv_simd[16];
+  uint8_t iv_ref[16];
+  unsigned int i, j;
+
+  printf("selftest: checking CBC mode decryption camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < sizeof(src); i++)
+    src[i] = ((i + 3221) * 1231) & 0xff;
+
+  for (j = 0; j < sizeof(lengths) / sizeof(lengths[0]); j++) {
+    memcpy(iv_ref, iv, 16);
+    memset(ref, 0xaa, sizeof(ref));
+    Camellia_cbc_decrypt(src, ref, lengths[j], iv_ref, &ctx_ref);
+
+    /* Out-of-place. */
+    memcpy(iv_simd, iv, 16);
+    memset(dst, 0xaa, sizeof(dst));
+    assert(cbc_decrypt(&ctx_simd, dst, src, lengths[j], iv_simd) == 0);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(iv_simd, iv_ref, 16) == 0);
+
+    /* In-place. */
+    memcpy(iv_simd, iv, 16);
+    memcpy(dst, src, sizeof(dst));
+    memcpy(&ref[lengths[j]], &src[lengths[j]], sizeof(ref) - lengths[j]);
+    assert(cbc_decrypt(&ctx_simd, dst, dst, lengths[j], iv_simd) == 0);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(iv_simd, iv_ref, 16) == 0);
+  }
+
+  /* Lengths that are not multiple of block size are rejected, output and
+   * IV are left untouched. */
+  for (j = 0; j < sizeof(bad_lengths) / sizeof(bad_lengths[0]); j++) {
+    memcpy(iv_simd, iv, 16);
+    memset(dst, 0xaa, sizeof(dst));
+    assert(cbc_decrypt(&ctx_simd, dst, src, bad_lengths[j], iv_simd) == -1);
+    for (i = 0; i < sizeof(dst); i++)
+      assert(dst[i] == 0xaa);
+    assert(memcmp(iv_simd, iv, 16) == 0);
+  }
+}
+
+static void Camellia_cbc_encrypt(const void *src, void *dst, size_t nbytes,
+				 uint8_t *iv, CAMELLIA_KEY *ctx)
+{
+  const uint8_t *in = src;
+  uint8_t *out = dst;
+  size_t i;
+
+  for (; nbytes >= 16; nbytes -= 16) {
+    for (i = 0; i < 16; i++)
+      out[i] = in[i] ^ iv[i];
+    Camellia_encrypt(out, out, ctx);
+    memcpy(iv, out, 16);
+    out += 16;
+    in += 16;
+  }
+}
+
+static void Camellia_cfb_decrypt(const void *src, void *dst, size_t nbytes,
+				 uint8_t *iv, CAMELLIA_KEY *ctx)
+{
+  const uint8_t *in = src;
+  uint8_t *out = dst;
+  uint8_t ks[16];
+  size_t i;
+
+  while (nbytes) {
+    size_t n = nbytes < 16 ? nbytes : 16;
+
+    Camellia_encrypt(iv, ks, ctx);
+    if (n == 16)
+      memcpy(iv, in, 16);
+    for (i = 0; i < n; i++)
+      out[i] = in[i] ^ ks[i];
+    out += n;
+    in += n;
+    nbytes -= n;
+  }
+}
+
+static void selftest_cfb_dec(const char *variant, mode_crypt_fn_t cfb_decrypt,
+			     const uint8_t *key, int nbits)
+{
+  static const size_t lengths[] = {
+    0, 1, 15, 16, 17, 16 * 16 - 1, 16 * 16, 16 * 16 + 1, 32 * 16 - 1,
+    32 * 16, 32 * 16 + 15, 33 * 16, 64 * 16, 64 * 16 + 7, 99 * 16 + 3
+  };
+  static const uint8_t iv[16] = {
+    0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+    0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10
+  };
+  struct camellia_simd_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  uint8_t src[100 * 16];
+  uint8_t dst[100 * 16];
+  uint8_t ref[100 * 16];
+  uint8_t iv_simd[16];
+  uint8_t iv_ref[16];
+  unsigned int i, j;
+
+  printf("selftest: checking CFB mode decryption camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < sizeof(src); i++)
+    src[i] = ((i + 3221) * 1231) & 0xff;
+
+  for (j = 0; j < sizeof(lengths) / sizeof(lengths[0]); j++) {
+    memcpy(iv_ref, iv, 16);
+    memset(ref, 0xaa, sizeof(ref));
+    Camellia_cfb_decrypt(src, ref, lengths[j], iv_ref, &ctx_ref);
+
+    /* Out-of-place. */
+    memcpy(iv_simd, iv, 16);
+    memset(dst, 0xaa, sizeof(dst));
+    cfb_decrypt(&ctx_simd, dst, src, lengths[j], iv_simd);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(iv_simd, iv_ref, 16) == 0);
+
+    /* In-place. */
+    memcpy(iv_simd, iv, 16);
+    memcpy(dst, src, sizeof(dst));
+    memcpy(&ref[lengths[j]], &src[lengths[j]], sizeof(ref) - lengths[j]);
+    cfb_decrypt(&ctx_simd, dst, dst, lengths[j], iv_simd);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(iv_simd, iv_ref, 16) == 0);
+  }
+}
+
+static void xts_mul_x_ref(uint8_t *t)
+{
+  uint8_t carry = 0;
+  int i;
+
+  for (i = 0; i < 16; i++) {
+    uint8_t next = t[i] >> 7;
+    t[i] = (t[i] << 1) | carry;
+    carry = next;
+  }
+  if (carry)
+    t[0] ^= 0x87;
+}
+
+static void Camellia_xts_crypt_blk(const uint8_t *src, uint8_t *dst,
+				   const uint8_t *tweak, CAMELLIA_KEY *ctx,
+				   int encrypt)
+{
+  uint8_t tmp[16];
+  int i;
+
+  for (i = 0; i < 16; i++)
+    tmp[i] = src[i] ^ tweak[i];
+  if (encrypt)
+    Camellia_encrypt(tmp, tmp, ctx);
+  else
+    Camellia_decrypt(tmp, tmp, ctx);
+  for (i = 0; i < 16; i++)
+    dst[i] = tmp[i] ^ tweak[i];
+}
+
+/* IEEE P1619 XTS with ciphertext stealing, TWEAK is encrypted tweak. */
+static void Camellia_xts_crypt(const void *src, void *dst, size_t nbytes,
+			       uint8_t *tweak, CAMELLIA_KEY *ctx, int encrypt)
+{
+  const uint8_t *in = src;
+  uint8_t *out = dst;
+  size_t rem = nbytes % 16;
+  uint8_t next_tweak[16];
+  uint8_t tmp[16];
+
+  while (nbytes >= 16 && !(rem && nbytes < 32)) {
+    Camellia_xts_crypt_blk(in, out, tweak, ctx, encrypt);
+    xts_mul_x_ref(tweak);
+    out += 16;
+    in += 16;
+    nbytes -= 16;
+  }
+
+  if (!rem || nbytes < 16)
+    return;
+
+  /* Ciphertext stealing for final full and partial blocks. */
+  memcpy(next_tweak, tweak, 16);
+  xts_mul_x_ref(next_tweak);
+  Camellia_xts_crypt_blk(in, tmp, encrypt ? tweak : next_tweak, ctx, encrypt);
+  memcpy(out + 16, tmp, rem);
+  memcpy(tmp, in + 16, rem);
+  Camellia_xts_crypt_blk(tmp, out, encrypt ? next_tweak : tweak, ctx, encrypt);
+}
+
+typedef void (*xts_crypt_fn_t)(struct camellia_simd_ctx *ctx, void *out,
+			       const void *in, size_t nbytes, void *tweak);
+
+static void selftest_xts(const char *variant, xts_crypt_fn_t xts_encrypt,
+			 xts_crypt_fn_t xts_decrypt, const uint8_t *key,
+			 int nbits)
+{
+  static const size_t lengths[] = {
+    16, 17, 31, 32, 16 * 16 - 1, 16 * 16, 16 * 16 + 1, 17 * 16 + 15,
+    32 * 16 - 1, 32 * 16, 32 * 16 + 8, 33 * 16 + 1, 48 * 16, 64 * 16 + 7,
+    99 * 16 + 3
+  };
+  static const uint8_t tweak[16] = {
+    0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+    0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x90
+  };
+  struct camellia_simd_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  uint8_t src[100 * 16];
+  uint8_t dst[100 * 16];
+  uint8_t ref[100 * 16];
+  uint8_t tweak_simd[16];
+  uint8_t tweak_ref[16];
+  unsigned int i, j;
+  int encrypt;
+
+  printf("selftest: checking XTS mode camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < sizeof(src); i++)
+    src[i] = ((i + 3221) * 1231) & 0xff;
+
+  for (encrypt = 0; encrypt < 2; encrypt++) {
+    xts_crypt_fn_t xts_crypt = encrypt ? xts_encrypt : xts_decrypt;
+
+    for (j = 0; j < sizeof(lengths) / sizeof(lengths[0]); j++) {
+      memcpy(tweak_ref, tweak, 16);
+      memset(ref, 0xaa, sizeof(ref));
+      Camellia_xts_crypt(src, ref, lengths[j], tweak_ref, &ctx_ref, encrypt);
+
+      /* Out-of-place. */
+      memcpy(tweak_simd, tweak, 16);
+      memset(dst, 0xaa, sizeof(dst));
+      xts_crypt(&ctx_simd, dst, src, lengths[j], tweak_simd);
+      assert(memcmp(dst, ref, sizeof(ref)) == 0);
+      if (lengths[j] % 16 == 0)
+	assert(memcmp(tweak_simd, tweak_ref, 16) == 0);
+
+      /* In-place. */
+      memcpy(tweak_simd, tweak, 16);
+      memcpy(dst, src, sizeof(dst));
+      memcpy(&ref[lengths[j]], &src[lengths[j]], sizeof(ref) - lengths[j]);
+      xts_crypt(&ctx_simd, dst, dst, lengths[j], tweak_simd);
+      assert(memcmp(dst, ref, sizeof(ref)) == 0);
+      if (lengths[j] % 16 == 0)
+	assert(memcmp(tweak_simd, tweak_ref, 16) == 0);
+
+      /* Decryption reverses encryption. */
+      if (encrypt) {
+	memcpy(tweak_simd, tweak, 16);
+	xts_decrypt(&ctx_simd, dst, dst, lengths[j], tweak_simd);
+	assert(memcmp(dst, src, sizeof(dst)) == 0);
+      }
+    }
+  }
+}
+
+static void ocb_double_ref(uint8_t *dst, const uint8_t *src)
+{
+  uint8_t carry = src[0] >> 7;
+  int i;
+
+  for (i = 0; i < 15; i++)
+    dst[i] = (src[i] << 1) | (src[i + 1] >> 7);
+  dst[15] = (src[15] << 1) ^ (carry * 0x87);
+}
+
+static void ocb_xor_ref(uint8_t *dst, const uint8_t *src, size_t len)
+{
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    dst[i] ^= src[i];
+}
+
+/* Offset += L[ntz(blkn)], L[] is derived on each call by doubling. */
+static void ocb_offset_next_ref(uint8_t *offset, uint64_t blkn,
+				const uint8_t *L_dollar)
+{
+  uint8_t L[16];
+
+  ocb_double_ref(L, L_dollar);
+  while (!(blkn & 1)) {
+    ocb_double_ref(L, L);
+    blkn >>= 1;
+  }
+  ocb_xor_ref(offset, L, 16);
+}
+
+/* RFC 7253 OCB with 128-bit tag, serially one block at a time. */
+static void Camellia_ocb_crypt(const void *src, void *dst, size_t nbytes,
+			       const uint8_t *nonce, size_t noncelen,
+			       const uint8_t *ad, size_t adlen, uint8_t *tag,
+			       CAMELLIA_KEY *ctx, int encrypt)
+{
+  const uint8_t *in = src;
+  uint8_t *out = dst;
+  uint8_t L_star[16] = { 0 };
+  uint8_t L_dollar[16];
+  uint8_t offset[16] = { 0 };
+  uint8_t checksum[16] = { 0 };
+  uint8_t sum[16] = { 0 };
+  uint8_t stretch[24];
+  uint8_t tmp[16];
+  unsigned int bottom, i;
+  uint64_t blkn;
+
+  Camellia_encrypt(L_star, L_star, ctx);
+  ocb_double_ref(L_dollar, L_star);
+
+  /* Hash associated data. */
+  for (blkn = 1; adlen >= 16; blkn++, ad += 16, adlen -= 16) {
+    ocb_offset_next_ref(offset, blkn, L_dollar);
+    memcpy(tmp, ad, 16);
+    ocb_xor_ref(tmp, offset, 16);
+    Camellia_encrypt(tmp, tmp, ctx);
+    ocb_xor_ref(sum, tmp, 16);
+  }
+  if (adlen) {
+    ocb_xor_ref(offset, L_star, 16);
+    memset(tmp, 0, 16);
+    memcpy(tmp, ad, adlen);
+    tmp[adlen] = 0x80;
+    ocb_xor_ref(tmp, offset, 16);
+    Camellia_encrypt(tmp, tmp, ctx);
+    ocb_xor_ref(sum, tmp, 16);
+  }
+
+  /* Initial offset from nonce. */
+  memset(tmp, 0, 16);
+  memcpy(&tmp[16 - noncelen], nonce, noncelen);
+  tmp[15 - noncelen] |= 0x01;
+  bottom = tmp[15] & 0x3f;
+  tmp[15] &= 0xc0;
+  Camellia_encrypt(tmp, stretch, ctx);
+  for (i = 0; i < 8; i++)
+    stretch[16 + i] = stretch[i] ^ stretch[i + 1];
+  for (i = 0; i < 16; i++)
+    offset[i] = (stretch[i + bottom / 8] << (bottom % 8)) |
+		(stretch[i + bottom / 8 + 1] >> (8 - bottom % 8));
+
+  for (blkn = 1; nbytes >= 16; blkn++, in += 16, out += 16, nbytes -= 16) {
+    ocb_offset_next_ref(offset, blkn, L_dollar);
+    memcpy(tmp, in, 16);
+    if (encrypt)
+      ocb_xor_ref(checksum, tmp, 16);
+    ocb_xor_ref(tmp, offset, 16);
+    if (encrypt)
+      Camellia_encrypt(tmp, tmp, ctx);
+    else
+      Camellia_decrypt(tmp, tmp, ctx);
+    ocb_xor_ref(tmp, offset, 16);
+    if (!encrypt)
+      ocb_xor_ref(checksum, tmp, 16);
+    memcpy(out, tmp, 16);
+  }
+  if (nbytes) {
+    ocb_xor_ref(offset, L_star, 16);
+    Camellia_encrypt(offset, tmp, ctx);
+    ocb_xor_ref(tmp, in, nbytes);
+    if (!encrypt)
+      ocb_xor_ref(checksum, tmp, nbytes);
+    else
+      ocb_xor_ref(checksum, in, nbytes);
+    checksum[nbytes] ^= 0x80;
+    memcpy(out, tmp, nbytes);
+  }
+
+  ocb_xor_ref(checksum, offset, 16);
+  ocb_xor_ref(checksum, L_dollar, 16);
+  Camellia_encrypt(checksum, tag, ctx);
+  ocb_xor_ref(tag, sum, 16);
+}
+
+typedef void (*ocb_encrypt_fn_t)(struct camellia_ocb_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *nonce, size_t noncelen,
+				 const void *ad, size_t adlen, void *tag);
+typedef int (*ocb_decrypt_fn_t)(struct camellia_ocb_ctx *ctx, void *out,
+				const void *in, size_t nbytes,
+				const void *nonce, size_t noncelen,
+				const void *ad, size_t adlen, const void *tag);
+
+static void selftest_ocb(const char *variant, ocb_encrypt_fn_t ocb_encrypt,
+			 ocb_decrypt_fn_t ocb_decrypt, const uint8_t *key,
+			 int nbits)
+{
+  static const size_t lengths[] = {
+    0, 1, 15, 16, 17, 31, 32, 16 * 16 - 1, 16 * 16, 16 * 16 + 1,
+    17 * 16 + 15, 32 * 16 - 1, 32 * 16, 32 * 16 + 8, 33 * 16 + 1, 48 * 16,
+    64 * 16 + 7, 99 * 16 + 3
+  };
+  static const size_t adlengths[] = { 0, 1, 16, 33, 16 * 16, 47 * 16 + 5 };
+  static const uint8_t nonce[15] = {
+    0xbb,0xaa,0x99,0x88,0x77,0x66,0x55,0x44,
+    0x33,0x22,0x11,0x00,0x0f,0x1e,0x2d
+  };
+  static struct camellia_ocb_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  uint8_t src[100 * 16];
+  uint8_t dst[100 * 16];
+  uint8_t ref[100 * 16];
+  uint8_t ctext[100 * 16];
+  uint8_t ad[48 * 16];
+  uint8_t tag_simd[16];
+  uint8_t tag_ref[16];
+  unsigned int i, j;
+
+  printf("selftest: checking OCB mode camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_ocb_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < sizeof(src); i++)
+    src[i] = ((i + 3221) * 1231) & 0xff;
+  for (i = 0; i < sizeof(ad); i++)
+    ad[i] = ((i + 1237) * 3221) & 0xff;
+
+  for (j = 0; j < sizeof(lengths) / sizeof(lengths[0]); j++) {
+    size_t adlen = adlengths[j % (sizeof(adlengths) / sizeof(adlengths[0]))];
+    size_t noncelen = 1 + (j * 7) % 15;
+
+    memset(ref, 0xaa, sizeof(ref));
+    Camellia_ocb_crypt(src, ref, lengths[j], nonce, noncelen, ad, adlen,
+		       tag_ref, &ctx_ref, 1);
+
+    /* Out-of-place. */
+    memset(dst, 0xaa, sizeof(dst));
+    ocb_encrypt(&ctx_simd, dst, src, lengths[j], nonce, noncelen, ad, adlen,
+		tag_simd);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(tag_simd, tag_ref, 16) == 0);
+
+    /* In-place. */
+    memcpy(dst, src, sizeof(dst));
+    memcpy(&ref[lengths[j]], &src[lengths[j]], sizeof(ref) - lengths[j]);
+    ocb_encrypt(&ctx_simd, dst, dst, lengths[j], nonce, noncelen, ad, adlen,
+		tag_simd);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(tag_simd, tag_ref, 16) == 0);
+
+    /* Decryption reverses encryption and checks tag. */
+    memcpy(ctext, ref, sizeof(ctext));
+    Camellia_ocb_crypt(ctext, ref, lengths[j], nonce, noncelen, ad, adlen,
+		       tag_ref, &ctx_ref, 0);
+    assert(memcmp(ref, src, lengths[j]) == 0);
+    assert(memcmp(tag_simd, tag_ref, 16) == 0);
+
+    memset(dst, 0xaa, sizeof(dst));
+    assert(ocb_decrypt(&ctx_simd, dst, ctext, lengths[j], nonce, noncelen,
+		       ad, adlen, tag_simd) == 0);
+    assert(memcmp(dst, src, lengths[j]) == 0);
+
+    memcpy(dst, ctext, sizeof(dst));
+    assert(ocb_decrypt(&ctx_simd, dst, dst, lengths[j], nonce, noncelen,
+		       ad, adlen, tag_simd) == 0);
+    assert(memcmp(dst, src, lengths[j]) == 0);
+
+    /* Modified tag, ciphertext or associated data is rejected. */
+    tag_simd[j % 16] ^= 0x01;
+    assert(ocb_decrypt(&ctx_simd, dst, ctext, lengths[j], nonce, noncelen,
+		       ad, adlen, tag_simd) == -1);
+    tag_simd[j % 16] ^= 0x01;
+    if (lengths[j]) {
+      ctext[lengths[j] / 2] ^= 0x80;
+      assert(ocb_decrypt(&ctx_simd, dst, ctext, lengths[j], nonce, noncelen,
+			 ad, adlen, tag_simd) == -1);
+      ctext[lengths[j] / 2] ^= 0x80;
+    }
+    if (adlen) {
+      ad[adlen - 1] ^= 0x04;
+      assert(ocb_decrypt(&ctx_simd, dst, ctext, lengths[j], nonce, noncelen,
+			 ad, adlen, tag_simd) == -1);
+      ad[adlen - 1] ^= 0x04;
+    }
+  }
+}
+
+/* GF(2^128) multiplication as in NIST SP 800-38D, one bit at a time. */
+static void gcm_gfmul_ref(uint8_t *x, const uint8_t *h)
+{
+  uint8_t z[16] = { 0 };
+  uint8_t v[16];
+  uint8_t lsb;
+  int i, j;
+
+  memcpy(v, h, 16);
+  for (i = 0; i < 128; i++) {
+    if ((x[i / 8] >> (7 - i % 8)) & 1)
+      ocb_xor_ref(z, v, 16);
+    lsb = v[15] & 1;
+    for (j = 15; j > 0; j--)
+      v[j] = (v[j] >> 1) | (v[j - 1] << 7);
+    v[0] = (v[0] >> 1) ^ (lsb * 0xe1);
+  }
+  memcpy(x, z, 16);
+}
+
+static void gcm_ghash_ref(uint8_t *hash, const uint8_t *h, const uint8_t *in,
+			  size_t len)
+{
+  uint8_t tmp[16];
+
+  for (; len; in += 16, len -= len < 16 ? len : 16) {
+    memset(tmp, 0, 16);
+    memcpy(tmp, in, len < 16 ? len : 16);
+    ocb_xor_ref(hash, tmp, 16);
+    gcm_gfmul_ref(hash, h);
+  }
+}
+
+static void gcm_ghash_lengths_ref(uint8_t *hash, const uint8_t *h,
+				  uint64_t len1, uint64_t len2)
+{
+  uint8_t tmp[16];
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    tmp[7 - i] = (len1 * 8) >> (i * 8);
+    tmp[15 - i] = (len2 * 8) >> (i * 8);
+  }
+  gcm_ghash_ref(hash, h, tmp, 16);
+}
+
+/* NIST SP 800-38D GCM with 128-bit tag, serially one block at a time. */
+static void Camellia_gcm_crypt(const void *src, void *dst, size_t nbytes,
+			       const uint8_t *iv, size_t ivlen,
+			       const uint8_t *ad, size_t adlen, uint8_t *tag,
+			       CAMELLIA_KEY *ctx, int encrypt)
+{
+  const uint8_t *in = src;
+  uint8_t *out = dst;
+  uint8_t h[16] = { 0 };
+  uint8_t j0[16] = { 0 };
+  uint8_t ctr[16];
+  uint8_t hash[16] = { 0 };
+  uint8_t tmp[16];
+  size_t len = nbytes;
+  size_t i, n;
+
+  Camellia_encrypt(h, h, ctx);
+
+  if (ivlen == 12) {
+    memcpy(j0, iv, 12);
+    j0[15] = 1;
+  } else {
+    gcm_ghash_ref(j0, h, iv, ivlen);
+    gcm_ghash_lengths_ref(j0, h, 0, ivlen);
+  }
+
+  gcm_ghash_ref(hash, h, ad, adlen);
+
+  memcpy(ctr, j0, 16);
+  for (; nbytes; in += n, out += n, nbytes -= n) {
+    n = nbytes < 16 ? nbytes : 16;
+
+    /* 32-bit counter increment. */
+    for (i = 15; i >= 12; i--)
+      if (++ctr[i] != 0)
+	break;
+
+    Camellia_encrypt(ctr, tmp, ctx);
+    if (!encrypt)
+      gcm_ghash_ref(hash, h, in, n);
+    for (i = 0; i < n; i++)
+      out[i] = in[i] ^ tmp[i];
+    if (encrypt)
+      gcm_ghash_ref(hash, h, out, n);
+  }
+
+  gcm_ghash_lengths_ref(hash, h, adlen, len);
+  Camellia_encrypt(j0, tag, ctx);
+  ocb_xor_ref(tag, hash, 16);
+}
+
+typedef void (*gcm_encrypt_fn_t)(struct camellia_gcm_ctx *ctx, void *out,
+				 const void *in, size_t nbytes,
+				 const void *iv, size_t ivlen,
+				 const void *ad, size_t adlen, void *tag);
+typedef int (*gcm_decrypt_fn_t)(struct camellia_gcm_ctx *ctx, void *out,
+				const void *in, size_t nbytes,
+				const void *iv, size_t ivlen,
+				const void *ad, size_t adlen, const void *tag);
+
+static void selftest_gcm(const char *variant, gcm_encrypt_fn_t gcm_encrypt,
+			 gcm_decrypt_fn_t gcm_decrypt, const uint8_t *key,
+			 int nbits)
+{
+  static const size_t lengths[] = {
+    0, 1, 15, 16, 17, 31, 32, 16 * 16 - 1, 16 * 16, 16 * 16 + 1,
+    17 * 16 + 15, 32 * 16 - 1, 32 * 16, 32 * 16 + 8, 33 * 16 + 1, 48 * 16,
+    64 * 16 + 7, 99 * 16 + 3
+  };
+  static const size_t adlengths[] = { 0, 1, 16, 33, 16 * 16, 47 * 16 + 5 };
+  static const size_t ivlengths[] = { 12, 1, 16, 12, 60, 8 };
+  static const uint8_t iv[60] = {
+    0xca,0xfe,0xba,0xbe,0xfa,0xce,0xdb,0xad,0xde,0xca,0xf8,0x88,
+    0xbb,0xaa,0x99,0x88,0x77,0x66,0x55,0x44,0x33,0x22,0x11,0x00,
+    0x0f,0x1e,0x2d,0x3c,0x4b,0x5a,0x69,0x78,0x87,0x96,0xa5,0xb4,
+    0xc3,0xd2,0xe1,0xf0,0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,
+    0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10,0xff,0xff,0xff,0xfe
+  };
+  static struct camellia_gcm_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  uint8_t src[100 * 16];
+  uint8_t dst[100 * 16];
+  uint8_t ref[100 * 16];
+  uint8_t ctext[100 * 16];
+  uint8_t ad[48 * 16];
+  uint8_t tag_simd[16];
+  uint8_t tag_ref[16];
+  unsigned int i, j;
+
+  printf("selftest: checking GCM mode camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_gcm_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < sizeof(src); i++)
+    src[i] = ((i + 3221) * 1231) & 0xff;
+  for (i = 0; i < sizeof(ad); i++)
+    ad[i] = ((i + 1237) * 3221) & 0xff;
+
+  for (j = 0; j < sizeof(lengths) / sizeof(lengths[0]); j++) {
+    size_t adlen = adlengths[j % (sizeof(adlengths) / sizeof(adlengths[0]))];
+    size_t ivlen = ivlengths[j % (sizeof(ivlengths) / sizeof(ivlengths[0]))];
+
+    memset(ref, 0xaa, sizeof(ref));
+    Camellia_gcm_crypt(src, ref, lengths[j], iv, ivlen, ad, adlen,
+		       tag_ref, &ctx_ref, 1);
+
+    /* Out-of-place. */
+    memset(dst, 0xaa, sizeof(dst));
+    gcm_encrypt(&ctx_simd, dst, src, lengths[j], iv, ivlen, ad, adlen,
+		tag_simd);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(tag_simd, tag_ref, 16) == 0);
+
+    /* In-place. */
+    memcpy(dst, src, sizeof(dst));
+    memcpy(&ref[lengths[j]], &src[lengths[j]], sizeof(ref) - lengths[j]);
+    gcm_encrypt(&ctx_simd, dst, dst, lengths[j], iv, ivlen, ad, adlen,
+		tag_simd);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(tag_simd, tag_ref, 16) == 0);
+
+    /* Decryption reverses encryption and checks tag. */
+    memcpy(ctext, ref, sizeof(ctext));
+    Camellia_gcm_crypt(ctext, ref, lengths[j], iv, ivlen, ad, adlen,
+		       tag_ref, &ctx_ref, 0);
+    assert(memcmp(ref, src, lengths[j]) == 0);
+    assert(memcmp(tag_simd, tag_ref, 16) == 0);
+
+    memset(dst, 0xaa, sizeof(dst));
+    assert(gcm_decrypt(&ctx_simd, dst, ctext, lengths[j], iv, ivlen,
+		       ad, adlen, tag_simd) == 0);
+    assert(memcmp(dst, src, lengths[j]) == 0);
+
+    memcpy(dst, ctext, sizeof(dst));
+    assert(gcm_decrypt(&ctx_simd, dst, dst, lengths[j], iv, ivlen,
+		       ad, adlen, tag_simd) == 0);
+    assert(memcmp(dst, src, lengths[j]) == 0);
+
+    /* Modified tag, ciphertext or associated data is rejected. */
+    tag_simd[j % 16] ^= 0x01;
+    assert(gcm_decrypt(&ctx_simd, dst, ctext, lengths[j], iv, ivlen,
+		       ad, adlen, tag_simd) == -1);
+    tag_simd[j % 16] ^= 0x01;
+    if (lengths[j]) {
+      ctext[lengths[j] / 2] ^= 0x80;
+      assert(gcm_decrypt(&ctx_simd, dst, ctext, lengths[j], iv, ivlen,
+			 ad, adlen, tag_simd) == -1);
+      ctext[lengths[j] / 2] ^= 0x80;
+    }
+    if (adlen) {
+      ad[adlen - 1] ^= 0x04;
+      assert(gcm_decrypt(&ctx_simd, dst, ctext, lengths[j], iv, ivlen,
+			 ad, adlen, tag_simd) == -1);
+      ad[adlen - 1] ^= 0x04;
+    }
+  }
+}
+
+/* POLYVAL through GHASH as in RFC 8452, Appendix A: POLYVAL(H, X_1, ...)
+ * = ByteReverse(GHASH(mulX_GHASH(ByteReverse(H)), ByteReverse(X_1), ...)).
+ * Final partial block is padded with zeros. */
+static void polyval_ref(uint8_t *hash, const uint8_t *h, const uint8_t *in,
+			size_t len)
+{
+  uint8_t hg[16], sg[16], tmp[16];
+  uint8_t lsb;
+  int i;
+
+  for (i = 0; i < 16; i++) {
+    hg[i] = h[15 - i];
+    sg[i] = hash[15 - i];
+  }
+  lsb = hg[15] & 1;
+  for (i = 15; i > 0; i--)
+    hg[i] = (hg[i] >> 1) | (hg[i - 1] << 7);
+  hg[0] = (hg[0] >> 1) ^ (lsb * 0xe1);
+
+  for (; len; in += 16, len -= len < 16 ? len : 16) {
+    memset(tmp, 0, 16);
+    memcpy(tmp, in, len < 16 ? len : 16);
+    for (i = 0; i < 16; i++)
+      sg[i] ^= tmp[15 - i];
+    gcm_gfmul_ref(sg, hg);
+  }
+
+  for (i = 0; i < 16; i++)
+    hash[i] = sg[15 - i];
+}
+
+/* GCM-SIV CTR mode with 32-bit little-endian counter in first four bytes
+ * of initial counter block TAG with most significant bit set. */
+static void gcm_siv_ctr_ref(const uint8_t *in, uint8_t *out, size_t nbytes,
+			    const uint8_t *tag, CAMELLIA_KEY *ctx)
+{
+  uint8_t ctr[16];
+  uint8_t tmp[16];
+  uint32_t c;
+  size_t i, n;
+
+  memcpy(ctr, tag, 16);
+  ctr[15] |= 0x80;
+  c = ctr[0] | (ctr[1] << 8) | (ctr[2] << 16) | ((uint32_t)ctr[3] << 24);
+  for (; nbytes; in += n, out += n, nbytes -= n, c++) {
+    n = nbytes < 16 ? nbytes : 16;
+    ctr[0] = c;
+    ctr[1] = c >> 8;
+    ctr[2] = c >> 16;
+    ctr[3] = c >> 24;
+    Camellia_encrypt(ctr, tmp, ctx);
+    for (i = 0; i < n; i++)
+      out[i] = in[i] ^ tmp[i];
+  }
+}
+
+/* RFC 8452 GCM-SIV with Camellia, serially one block at a time. For
+ * decryption, TAG is received tag on entry and is replaced with computed
+ * tag. */
+static void Camellia_gcm_siv_crypt(const void *src, void *dst, size_t nbytes,
+				   const uint8_t *nonce, const uint8_t *ad,
+				   size_t adlen, uint8_t *tag,
+				   const uint8_t *key, int nbits, int encrypt)
+{
+  CAMELLIA_KEY ctx = { 0 };
+  uint8_t auth_key[16];
+  uint8_t enc_key[32];
+  uint8_t hash[16] = { 0 };
+  uint8_t blk[16];
+  uint8_t tmp[16];
+  int i;
+
+  /* Per-nonce key derivation. */
+  Camellia_set_key(key, nbits, &ctx);
+  for (i = 0; i < 2 + nbits / 64; i++) {
+    memset(blk, 0, 16);
+    blk[0] = i;
+    memcpy(blk + 4, nonce, 12);
+    Camellia_encrypt(blk, tmp, &ctx);
+    memcpy(i < 2 ? auth_key + i * 8 : enc_key + (i - 2) * 8, tmp, 8);
+  }
+  Camellia_set_key(enc_key, nbits, &ctx);
+
+  if (!encrypt)
+    gcm_siv_ctr_ref(src, dst, nbytes, tag, &ctx);
+
+  polyval_ref(hash, auth_key, ad, adlen);
+  polyval_ref(hash, auth_key, encrypt ? src : dst, nbytes);
+  for (i = 0; i < 8; i++) {
+    blk[i] = ((uint64_t)adlen * 8) >> (i * 8);
+    blk[8 + i] = ((uint64_t)nbytes * 8) >> (i * 8);
+  }
+  polyval_ref(hash, auth_key, blk, 16);
+
+  for (i = 0; i < 12; i++)
+    hash[i] ^= nonce[i];
+  hash[15] &= 0x7f;
+  Camellia_encrypt(hash, tag, &ctx);
+
+  if (encrypt)
+    gcm_siv_ctr_ref(src, dst, nbytes, tag, &ctx);
+}
+
+typedef void (*gcm_siv_encrypt_fn_t)(struct camellia_gcm_siv_ctx *ctx,
+				     void *out, const void *in, size_t nbytes,
+				     const void *nonce, const void *ad,
+				     size_t adlen, void *tag);
+typedef int (*gcm_siv_decrypt_fn_t)(struct camellia_gcm_siv_ctx *ctx,
+				    void *out, const void *in, size_t nbytes,
+				    const void *nonce, const void *ad,
+				    size_t adlen, const void *tag);
+
+static void selftest_gcm_siv(const char *variant,
+			     gcm_siv_encrypt_fn_t gcm_siv_encrypt,
+			     gcm_siv_decrypt_fn_t gcm_siv_decrypt,
+			     const uint8_t *key, int nbits)
+{
+  static const size_t lengths[] = {
+    0, 1, 15, 16, 17, 31, 32, 16 * 16 - 1, 16 * 16, 16 * 16 + 1,
+    17 * 16 + 15, 32 * 16 - 1, 32 * 16, 32 * 16 + 8, 33 * 16 + 1, 48 * 16,
+    64 * 16 + 7, 99 * 16 + 3
+  };
+  static const size_t adlengths[] = { 0, 1, 16, 33, 16 * 16, 47 * 16 + 5 };
+  static struct camellia_gcm_siv_ctx ctx_simd;
+  uint8_t src[100 * 16];
+  uint8_t dst[100 * 16];
+  uint8_t ref[100 * 16];
+  uint8_t ctext[100 * 16];
+  uint8_t ad[48 * 16];
+  uint8_t nonce[12];
+  uint8_t tag_simd[16];
+  uint8_t tag_ref[16];
+  unsigned int i, j;
+
+  printf("selftest: checking GCM-SIV mode camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  assert(camellia_gcm_siv_keysetup_simd128(&ctx_simd, key, 24) == -1);
+  assert(camellia_gcm_siv_keysetup_simd128(&ctx_simd, key, nbits / 8) == 0);
+
+  for (i = 0; i < sizeof(src); i++)
+    src[i] = ((i + 3221) * 1231) & 0xff;
+  for (i = 0; i < sizeof(ad); i++)
+    ad[i] = ((i + 1237) * 3221) & 0xff;
+
+  for (j = 0; j < sizeof(lengths) / sizeof(lengths[0]); j++) {
+    size_t adlen = adlengths[j % (sizeof(adlengths) / sizeof(adlengths[0]))];
+
+    for (i = 0; i < sizeof(nonce); i++)
+      nonce[i] = (i + j * 17) * 0x35;
+
+    memset(ref, 0xaa, sizeof(ref));
+    Camellia_gcm_siv_crypt(src, ref, lengths[j], nonce, ad, adlen, tag_ref,
+			   key, nbits, 1);
+
+    /* Out-of-place. */
+    memset(dst, 0xaa, sizeof(dst));
+    gcm_siv_encrypt(&ctx_simd, dst, src, lengths[j], nonce, ad, adlen,
+		    tag_simd);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(tag_simd, tag_ref, 16) == 0);
+
+    /* In-place. */
+    memcpy(dst, src, sizeof(dst));
+    memcpy(&ref[lengths[j]], &src[lengths[j]], sizeof(ref) - lengths[j]);
+    gcm_siv_encrypt(&ctx_simd, dst, dst, lengths[j], nonce, ad, adlen,
+		    tag_simd);
+    assert(memcmp(dst, ref, sizeof(ref)) == 0);
+    assert(memcmp(tag_simd, tag_ref, 16) == 0);
+
+    /* Decryption reverses encryption and checks tag. */
+    memcpy(ctext, ref, sizeof(ctext));
+    Camellia_gcm_siv_crypt(ctext, ref, lengths[j], nonce, ad, adlen, tag_ref,
+			   key, nbits, 0);
+    assert(memcmp(ref, src, lengths[j]) == 0);
+    assert(memcmp(tag_simd, tag_ref, 16) == 0);
+
+    memset(dst, 0xaa, sizeof(dst));
+    assert(gcm_siv_decrypt(&ctx_simd, dst, ctext, lengths[j], nonce,
+			   ad, adlen, tag_simd) == 0);
+    assert(memcmp(dst, src, lengths[j]) == 0);
+
+    memcpy(dst, ctext, sizeof(dst));
+    assert(gcm_siv_decrypt(&ctx_simd, dst, dst, lengths[j], nonce,
+			   ad, adlen, tag_simd) == 0);
+    assert(memcmp(dst, src, lengths[j]) == 0);
+
+    /* Modified tag, ciphertext, associated data or nonce is rejected. */
+    tag_simd[j % 16] ^= 0x01;
+    assert(gcm_siv_decrypt(&ctx_simd, dst, ctext, lengths[j], nonce,
+			   ad, adlen, tag_simd) == -1);
+    tag_simd[j % 16] ^= 0x01;
+    if (lengths[j]) {
+      ctext[lengths[j] / 2] ^= 0x80;
+      assert(gcm_siv_decrypt(&ctx_simd, dst, ctext, lengths[j], nonce,
+			     ad, adlen, tag_simd) == -1);
+      ctext[lengths[j] / 2] ^= 0x80;
+    }
+    if (adlen) {
+      ad[adlen - 1] ^= 0x04;
+      assert(gcm_siv_decrypt(&ctx_simd, dst, ctext, lengths[j], nonce,
+			     ad, adlen, tag_simd) == -1);
+      ad[adlen - 1] ^= 0x04;
+    }
+    nonce[j % 12] ^= 0x10;
+    assert(gcm_siv_decrypt(&ctx_simd, dst, ctext, lengths[j], nonce,
+			   ad, adlen, tag_simd) == -1);
+  }
+}
+
+typedef void (*cbc_encrypt_multi_fn_t)(struct camellia_simd_ctx *ctx,
+				       struct camellia_cbc_stream *streams,
+				       size_t nstreams);
+
+static void selftest_cbc_enc_multi(const char *variant,
+				   cbc_encrypt_multi_fn_t cbc_encrypt_multi,
+				   const uint8_t *key, int nbits)
+{
+  enum { NSTREAMS = 75, MAXBLKS = 40 };
+  static uint8_t src[NSTREAMS][MAXBLKS * 16];
+  static uint8_t dst[NSTREAMS][MAXBLKS * 16];
+  static uint8_t ref[NSTREAMS][MAXBLKS * 16];
+  struct camellia_cbc_stream streams[NSTREAMS];
+  uint8_t iv_ref[NSTREAMS][16];
+  struct camellia_simd_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  unsigned int i, j;
+
+  printf("selftest: checking multi-stream CBC mode encryption camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < NSTREAMS; i++) {
+    /* Stream lengths vary from 0 to MAXBLKS blocks, every third stream is
+     * processed in-place. */
+    size_t nbytes = ((i * 17) % (MAXBLKS + 1)) * 16;
+
+    for (j = 0; j < sizeof(src[i]); j++)
+      src[i][j] = ((i * 4099 + j + 3221) * 1231) & 0xff;
+    for (j = 0; j < 16; j++)
+      iv_ref[i][j] = (i * 16 + j) & 0xff;
+
+    streams[i].in = src[i];
+    streams[i].out = (i % 3 == 0) ? src[i] : dst[i];
+    streams[i].nbytes = nbytes;
+    memcpy(streams[i].iv, iv_ref[i], 16);
+
+    memset(dst[i], 0xaa, sizeof(dst[i]));
+    memcpy(ref[i], (i % 3 == 0) ? src[i] : dst[i], sizeof(ref[i]));
+    Camellia_cbc_encrypt(src[i], ref[i], nbytes, iv_ref[i], &ctx_ref);
+  }
+
+  cbc_encrypt_multi(&ctx_simd, streams, NSTREAMS);
+
+  for (i = 0; i < NSTREAMS; i++) {
+    assert(memcmp(streams[i].out, ref[i], sizeof(ref[i])) == 0);
+    assert(memcmp(streams[i].iv, iv_ref[i], 16) == 0);
+  }
+}
+
+/* Absorbs LEN bytes to CBC-MAC state X, *POS bytes of current block are
+ * already absorbed. */
+static void ccm_mac_update_ref(uint8_t *x, unsigned int *pos,
+			       const uint8_t *data, size_t len,
+			       CAMELLIA_KEY *ctx)
+{
+  while (len--) {
+    x[(*pos)++] ^= *data++;
+    if (*pos == 16) {
+      Camellia_encrypt(x, x, ctx);
+      *pos = 0;
+    }
+  }
+}
+
+/* Pads partially absorbed CBC-MAC block with zeros. */
+static void ccm_mac_pad_ref(uint8_t *x, unsigned int *pos, CAMELLIA_KEY *ctx)
+{
+  if (*pos) {
+    Camellia_encrypt(x, x, ctx);
+    *pos = 0;
+  }
+}
+
+/* RFC 3610 CCM, serially one block at a time. */
+static void Camellia_ccm_crypt(const void *src, void *dst, size_t nbytes,
+			       const uint8_t *nonce, unsigned int noncelen,
+			       const uint8_t *ad, size_t adlen, uint8_t *tag,
+			       unsigned int taglen, CAMELLIA_KEY *ctx,
+			       int encrypt)
+{
+  const uint8_t *in = src;
+  uint8_t *out = dst;
+  uint8_t x[16] = { 0 };
+  uint8_t ctr[16] = { 0 };
+  uint8_t hdr[6];
+  uint8_t tmp[16];
+  unsigned int pos = 0;
+  unsigned int hdrlen;
+  size_t i, n;
+
+  /* B_0 */
+  x[0] = (adlen ? 0x40 : 0) | (((taglen - 2) / 2) << 3) | (14 - noncelen);
+  memcpy(&x[1], nonce, noncelen);
+  for (i = 15, n = nbytes; i > noncelen; i--, n >>= 8)
+    x[i] = n & 0xff;
+  Camellia_encrypt(x, x, ctx);
+
+  if (adlen) {
+    if (adlen < 0xff00) {
+      hdr[0] = adlen >> 8;
+      hdr[1] = adlen & 0xff;
+      hdrlen = 2;
+    } else {
+      hdr[0] = 0xff;
+      hdr[1] = 0xfe;
+      for (i = 0; i < 4; i++)
+	hdr[2 + i] = (adlen >> (24 - i * 8)) & 0xff;
+      hdrlen = 6;
+    }
+    ccm_mac_update_ref(x, &pos, hdr, hdrlen, ctx);
+    ccm_mac_update_ref(x, &pos, ad, adlen, ctx);
+    ccm_mac_pad_ref(x, &pos, ctx);
+  }
+
+  /* A_0 */
+  ctr[0] = 14 - noncelen;
+  memcpy(&ctr[1], nonce, noncelen);
+  Camellia_encrypt(ctr, tag, ctx);
+
+  for (; nbytes; in += n, out += n, nbytes -= n) {
+    n = nbytes < 16 ? nbytes : 16;
+
+    for (i = 15; i > noncelen; i--)
+      if (++ctr[i] != 0)
+	break;
+
+    Camellia_encrypt(ctr, tmp, ctx);
+    if (encrypt)
+      ccm_mac_update_ref(x, &pos, in, n, ctx);
+    for (i = 0; i < n; i++)
+      out[i] = in[i] ^ tmp[i];
+    if (!encrypt)
+      ccm_mac_update_ref(x, &pos, out, n, ctx);
+  }
+  ccm_mac_pad_ref(x, &pos, ctx);
+
+  ocb_xor_ref(tag, x, taglen);
+}
+
+typedef void (*ccm_encrypt_multi_fn_t)(struct camellia_simd_ctx *ctx,
+				       struct camellia_ccm_msg *msgs,
+				       size_t nmsgs);
+typedef int (*ccm_decrypt_multi_fn_t)(struct camellia_simd_ctx *ctx,
+				      struct camellia_ccm_msg *msgs,
+				      size_t nmsgs);
+
+static void selftest_ccm_multi(const char *variant,
+			       ccm_encrypt_multi_fn_t ccm_encrypt_multi,
+			       ccm_decrypt_multi_fn_t ccm_decrypt_multi,
+			       const uint8_t *key, int nbits)
+{
+  enum { NMSGS = 75, MAXBYTES = 40 * 16 + 15 };
+  static uint8_t src[NMSGS][MAXBYTES];
+  static uint8_t dst[NMSGS][MAXBYTES];
+  static uint8_t ref[NMSGS][MAXBYTES];
+  static uint8_t ad[NMSGS][64];
+  static struct camellia_ccm_msg msgs[NMSGS];
+  uint8_t tag_ref[NMSGS][16];
+  struct camellia_simd_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  unsigned int i, j;
+
+  printf("selftest: checking multi-message CCM mode camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < NMSGS; i++) {
+    /* Message lengths vary from 0 to MAXBYTES bytes, nonce lengths from 7 to
+     * 13 and tag lengths from 4 to 16. Every third message is processed
+     * in-place. */
+    size_t nbytes = (i * 97) % (MAXBYTES + 1);
+    size_t adlen = (i % 4 == 0) ? 0 : (i * 13) % sizeof(ad[i]);
+
+    for (j = 0; j < sizeof(src[i]); j++)
+      src[i][j] = ((i * 4099 + j + 3221) * 1231) & 0xff;
+    for (j = 0; j < sizeof(ad[i]); j++)
+      ad[i][j] = ((i * 4099 + j + 1237) * 3221) & 0xff;
+
+    msgs[i].in = src[i];
+    msgs[i].out = (i % 3 == 0) ? src[i] : dst[i];
+    msgs[i].nbytes = nbytes;
+    msgs[i].ad = ad[i];
+    msgs[i].adlen = adlen;
+    msgs[i].noncelen = 7 + i % 7;
+    msgs[i].taglen = 4 + 2 * (i % 7);
+    for (j = 0; j < msgs[i].noncelen; j++)
+      msgs[i].nonce[j] = (i * 16 + j) & 0xff;
+
+    memset(dst[i], 0xaa, sizeof(dst[i]));
+    memcpy(ref[i], (i % 3 == 0) ? src[i] : dst[i], sizeof(ref[i]));
+    Camellia_ccm_crypt(src[i], ref[i], nbytes, msgs[i].nonce,
+		       msgs[i].noncelen, ad[i], adlen, tag_ref[i],
+		       msgs[i].taglen, &ctx_ref, 1);
+  }
+
+  ccm_encrypt_multi(&ctx_simd, msgs, NMSGS);
+
+  for (i = 0; i < NMSGS; i++) {
+    assert(memcmp(msgs[i].out, ref[i], sizeof(ref[i])) == 0);
+    assert(memcmp(msgs[i].tag, tag_ref[i], msgs[i].taglen) == 0);
+  }
+
+  /* Decryption reverses encryption and checks tags, modified tag or
+   * ciphertext is rejected for that message only. */
+  for (i = 0; i < NMSGS; i++) {
+    for (j = 0; j < sizeof(src[i]); j++)
+      src[i][j] = ((i * 4099 + j + 3221) * 1231) & 0xff;
+
+    msgs[i].in = ref[i];
+    msgs[i].out = (i % 3 == 0) ? ref[i] : dst[i];
+  }
+  msgs[5].tag[1] ^= 0x01;
+  ref[9][0] ^= 0x80;
+
+  assert(ccm_decrypt_multi(&ctx_simd, msgs, NMSGS) == -1);
+
+  for (i = 0; i < NMSGS; i++) {
+    if (i == 5 || i == 9) {
+      assert(msgs[i].status == -1);
+      continue;
+    }
+
+    assert(msgs[i].status == 0);
+    assert(memcmp(msgs[i].out, src[i], msgs[i].nbytes) == 0);
+  }
+}
+
+/* NIST SP 800-38B CMAC with 128-bit tag, serially one block at a time. */
+static void Camellia_cmac(const void *src, size_t nbytes, uint8_t *tag,
+			  CAMELLIA_KEY *ctx)
+{
+  const uint8_t *in = src;
+  uint8_t K1[16], K2[16];
+  uint8_t x[16] = { 0 };
+  uint8_t last[16] = { 0 };
+  size_t rem;
+
+  Camellia_encrypt(x, K1, ctx);
+  ocb_double_ref(K1, K1);
+  ocb_double_ref(K2, K1);
+
+  for (; nbytes > 16; in += 16, nbytes -= 16) {
+    ocb_xor_ref(x, in, 16);
+    Camellia_encrypt(x, x, ctx);
+  }
+
+  rem = nbytes;
+  memcpy(last, in, rem);
+  if (rem == 16) {
+    ocb_xor_ref(last, K1, 16);
+  } else {
+    last[rem] = 0x80;
+    ocb_xor_ref(last, K2, 16);
+  }
+  ocb_xor_ref(x, last, 16);
+  Camellia_encrypt(x, tag, ctx);
+}
+
+typedef void (*cmac_batch_fn_t)(struct camellia_cmac_ctx *ctx,
+				const void *const *msgs, const size_t *lens,
+				void *tags, size_t n);
+typedef int (*cmac_verify_batch_fn_t)(struct camellia_cmac_ctx *ctx,
+				      const void *const *msgs,
+				      const size_t *lens, const void *tags,
+				      size_t n, int *status);
+
+static void selftest_cmac_batch(const char *variant,
+				cmac_batch_fn_t cmac_batch,
+				cmac_verify_batch_fn_t cmac_verify_batch,
+				const uint8_t *key, int nbits)
+{
+  enum { NMSGS = 75, MAXBYTES = 40 * 16 + 15 };
+  static uint8_t src[NMSGS][MAXBYTES];
+  static const void *msgs[NMSGS];
+  static size_t lens[NMSGS];
+  uint8_t tags[NMSGS][16];
+  uint8_t tag_ref[NMSGS][16];
+  int status[NMSGS];
+  struct camellia_cmac_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  unsigned int i, j;
+
+  printf("selftest: checking batched CMAC camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_cmac_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < NMSGS; i++) {
+    /* Message lengths vary from 0 to MAXBYTES bytes, every fifth message is
+     * multiple of block size. */
+    lens[i] = (i * 97) % (MAXBYTES + 1);
+    if (i % 5 == 0)
+      lens[i] -= lens[i] % 16;
+
+    for (j = 0; j < sizeof(src[i]); j++)
+      src[i][j] = ((i * 4099 + j + 3221) * 1231) & 0xff;
+    msgs[i] = src[i];
+
+    Camellia_cmac(src[i], lens[i], tag_ref[i], &ctx_ref);
+  }
+
+  memset(tags, 0xaa, sizeof(tags));
+  cmac_batch(&ctx_simd, msgs, lens, tags, NMSGS);
+  assert(memcmp(tags, tag_ref, sizeof(tags)) == 0);
+
+  assert(cmac_verify_batch(&ctx_simd, msgs, lens, tags, NMSGS, NULL) == 0);
+
+  /* Modified tag or message is rejected for that message only. */
+  tags[5][1] ^= 0x01;
+  src[9][lens[9] / 2] ^= 0x80;
+
+  assert(cmac_verify_batch(&ctx_simd, msgs, lens, tags, NMSGS,
+			   status) == -1);
+
+  for (i = 0; i < NMSGS; i++)
+    assert(status[i] == ((i == 5 || i == 9) ? -1 : 0));
+}
+
+/* RFC 5297 SIV with Camellia, serially one block at a time. For
+ * decryption, IV is received synthetic IV on entry and is replaced with
+ * computed IV. */
+static void Camellia_siv_crypt(const void *src, void *dst, size_t nbytes,
+			       const void *const *ad, const size_t *adlens,
+			       size_t nad, uint8_t *iv, CAMELLIA_KEY *mac_ctx,
+			       CAMELLIA_KEY *ctr_ctx, int encrypt)
+{
+  static const uint8_t zero[16];
+  const uint8_t *sn = encrypt ? src : dst;
+  uint8_t d[16], t[16], q[16];
+  uint8_t *buf;
+  size_t i;
+
+  if (!encrypt) {
+    memcpy(q, iv, 16);
+    q[8] &= 0x7f;
+    q[12] &= 0x7f;
+    Camellia_ctr_encrypt(src, dst, nbytes, q, ctr_ctx);
+  }
+
+  /* S2V */
+  Camellia_cmac(zero, 16, d, mac_ctx);
+  for (i = 0; i < nad; i++) {
+    Camellia_cmac(ad[i], adlens[i], t, mac_ctx);
+    ocb_double_ref(d, d);
+    ocb_xor_ref(d, t, 16);
+  }
+  if (nbytes >= 16) {
+    buf = malloc(nbytes);
+    memcpy(buf, sn, nbytes);
+    ocb_xor_ref(buf + nbytes - 16, d, 16);
+    Camellia_cmac(buf, nbytes, iv, mac_ctx);
+    free(buf);
+  } else {
+    memset(t, 0, 16);
+    memcpy(t, sn, nbytes);
+    t[nbytes] = 0x80;
+    ocb_double_ref(d, d);
+    ocb_xor_ref(t, d, 16);
+    Camellia_cmac(t, 16, iv, mac_ctx);
+  }
+
+  if (encrypt) {
+    memcpy(q, iv, 16);
+    q[8] &= 0x7f;
+    q[12] &= 0x7f;
+    Camellia_ctr_encrypt(src, dst, nbytes, q, ctr_ctx);
+  }
+}
+
+typedef void (*siv_encrypt_multi_fn_t)(struct camellia_siv_ctx *ctx,
+				       struct camellia_siv_msg *msgs,
+				       size_t nmsgs);
+typedef int (*siv_decrypt_multi_fn_t)(struct camellia_siv_ctx *ctx,
+				      struct camellia_siv_msg *msgs,
+				      size_t nmsgs);
+
+static void selftest_siv_multi(const char *variant,
+			       siv_encrypt_multi_fn_t siv_encrypt_multi,
+			       siv_decrypt_multi_fn_t siv_decrypt_multi,
+			       const uint8_t *key, int nbits)
+{
+  enum { NMSGS = 75, MAXBYTES = 40 * 16 + 15, MAXAD = 4 };
+  static uint8_t src[NMSGS][MAXBYTES];
+  static uint8_t dst[NMSGS][MAXBYTES];
+  static uint8_t ref[NMSGS][MAXBYTES];
+  static uint8_t ad[NMSGS][MAXAD][48];
+  static const void *ads[NMSGS][MAXAD];
+  static size_t adlens[NMSGS][MAXAD];
+  static struct camellia_siv_msg msgs[NMSGS];
+  uint8_t iv_ref[NMSGS][16];
+  static struct camellia_siv_ctx ctx_simd;
+  CAMELLIA_KEY mac_ref = { 0 };
+  CAMELLIA_KEY ctr_ref = { 0 };
+  uint8_t key2[64];
+  unsigned int i, j, k;
+
+  printf("selftest: checking multi-message SIV mode camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  /* SIV key is two cipher keys. */
+  memcpy(key2, key, nbits / 8);
+  for (i = 0; i < nbits / 8; i++)
+    key2[nbits / 8 + i] = key[i] ^ 0x5c;
+
+  Camellia_set_key(key2, nbits, &mac_ref);
+  Camellia_set_key(key2 + nbits / 8, nbits, &ctr_ref);
+  assert(camellia_siv_keysetup_simd128(&ctx_simd, key2, 16) == -1);
+  assert(camellia_siv_keysetup_simd128(&ctx_simd, key2, nbits / 4) == 0);
+
+  for (i = 0; i < NMSGS; i++) {
+    /* Message lengths vary from 0 to MAXBYTES bytes and number of
+     * associated data components from 0 to MAXAD. Every third message is
+     * processed in-place. */
+    size_t nbytes = (i % 2 == 0) ? (i * 97) % (MAXBYTES + 1) : i % 41;
+
+    for (j = 0; j < sizeof(src[i]); j++)
+      src[i][j] = ((i * 4099 + j + 3221) * 1231) & 0xff;
+    for (k = 0; k < MAXAD; k++) {
+      for (j = 0; j < sizeof(ad[i][k]); j++)
+	ad[i][k][j] = ((i * 4099 + k * 64 + j + 1237) * 3221) & 0xff;
+      ads[i][k] = ad[i][k];
+      adlens[i][k] = (i * 7 + k * 13) % (sizeof(ad[i][k]) + 1);
+    }
+
+    msgs[i].in = src[i];
+    msgs[i].out = (i % 3 == 0) ? src[i] : dst[i];
+    msgs[i].nbytes = nbytes;
+    msgs[i].ad = ads[i];
+    msgs[i].adlens = adlens[i];
+    msgs[i].nad = i % (MAXAD + 1);
+
+    memset(dst[i], 0xaa, sizeof(dst[i]));
+    memcpy(ref[i], (i % 3 == 0) ? src[i] : dst[i], sizeof(ref[i]));
+    Camellia_siv_crypt(src[i], ref[i], nbytes, ads[i], adlens[i],
+		       msgs[i].nad, iv_ref[i], &mac_ref, &ctr_ref, 1);
+  }
+
+  siv_encrypt_multi(&ctx_simd, msgs, NMSGS);
+
+  for (i = 0; i < NMSGS; i++) {
+    assert(memcmp(msgs[i].out, ref[i], sizeof(ref[i])) == 0);
+    assert(memcmp(msgs[i].iv, iv_ref[i], 16) == 0);
+  }
+
+  /* Decryption reverses encryption and checks IVs, modified IV, ciphertext
+   * or associated data is rejected for that message only. */
+  for (i = 0; i < NMSGS; i++) {
+    for (j = 0; j < sizeof(src[i]); j++)
+      src[i][j] = ((i * 4099 + j + 3221) * 1231) & 0xff;
+
+    msgs[i].in = ref[i];
+    msgs[i].out = (i % 3 == 0) ? ref[i] : dst[i];
+  }
+  msgs[5].iv[1] ^= 0x01;
+  ref[8][0] ^= 0x80;
+  ad[13][0][0] ^= 0x04;
+
+  assert(msgs[8].nbytes > 0 && msgs[13].nad > 0 && adlens[13][0] > 0);
+  assert(siv_decrypt_multi(&ctx_simd, msgs, NMSGS) == -1);
+
+  for (i = 0; i < NMSGS; i++) {
+    if (i == 5 || i == 8 || i == 13) {
+      assert(msgs[i].status == -1);
+      continue;
+    }
+
+    assert(msgs[i].status == 0);
+    assert(memcmp(msgs[i].out, src[i], msgs[i].nbytes) == 0);
+  }
+}
+
+/* RFC 3394 key wrap with default initial value, serially one block at a
+ * time. */
+static void Camellia_keywrap(const void *src, void *dst, size_t nbytes,
+			     CAMELLIA_KEY *ctx)
+{
+  uint8_t *out = dst;
+  uint8_t a[8];
+  uint8_t b[16];
+  size_t n = nbytes / 8;
+  size_t i, j;
+  uint64_t t;
+  int k;
+
+  memset(a, 0xa6, sizeof(a));
+  memmove(out + 8, src, nbytes);
+
+  for (j = 0; j < 6; j++) {
+    for (i = 0; i < n; i++) {
+      memcpy(b, a, 8);
+      memcpy(b + 8, out + 8 + i * 8, 8);
+      Camellia_encrypt(b, b, ctx);
+      memcpy(a, b, 8);
+      for (t = n * j + i + 1, k = 7; k >= 0; k--, t >>= 8)
+	a[k] ^= t & 0xff;
+      memcpy(out + 8 + i * 8, b + 8, 8);
+    }
+  }
+
+  memcpy(out, a, 8);
+}
+
+typedef void (*keywrap_batch_fn_t)(struct camellia_simd_ctx *ctx,
+				   struct camellia_keywrap_key *keys,
+				   size_t nkeys);
+typedef int (*keyunwrap_batch_fn_t)(struct camellia_simd_ctx *ctx,
+				    struct camellia_keywrap_key *keys,
+				    size_t nkeys);
+
+static void selftest_keywrap_batch(const char *variant,
+				   keywrap_batch_fn_t keywrap_batch,
+				   keyunwrap_batch_fn_t keyunwrap_batch,
+				   const uint8_t *key, int nbits)
+{
+  enum { NKEYS = 75, MAXBYTES = 32 * 8 };
+  static uint8_t src[NKEYS][MAXBYTES];
+  static uint8_t dst[NKEYS][MAXBYTES + 8];
+  static uint8_t ref[NKEYS][MAXBYTES + 8];
+  static struct camellia_keywrap_key keys[NKEYS];
+  struct camellia_simd_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  unsigned int i, j;
+
+  printf("selftest: checking batched key wrap camellia-%d/%s against reference implementation...\n",
+	 nbits, variant);
+
+  Camellia_set_key(key, nbits, &ctx_ref);
+  camellia_keysetup_simd128(&ctx_simd, key, nbits / 8);
+
+  for (i = 0; i < NKEYS; i++) {
+    /* Key data lengths vary from 16 to MAXBYTES bytes. Every third key is
+     * processed in-place. */
+    size_t nbytes = 16 + ((i * 97) % (MAXBYTES - 8)) / 8 * 8;
+
+    for (j = 0; j < sizeof(src[i]); j++)
+      src[i][j] = ((i * 4099 + j + 3221) * 1231) & 0xff;
+    memcpy(dst[i], src[i], sizeof(src[i]));
+
+    keys[i].in = (i % 3 == 0) ? dst[i] : src[i];
+    keys[i].out = dst[i];
+    keys[i].nbytes = nbytes;
+
+    Camellia_keywrap(src[i], ref[i], nbytes, &ctx_ref);
+  }
+
+  keywrap_batch(&ctx_simd, keys, NKEYS);
+
+  for (i = 0; i < NKEYS; i++) {
+    assert(keys[i].status == 0);
+    assert(memcmp(dst[i], ref[i], keys[i].nbytes + 8) == 0);
+  }
+
+  /* Unwrap reverses wrap and checks integrity, modified wrapped key is
+   * rejected and cleared for that key only. */
+  for (i = 0; i < NKEYS; i++) {
+    keys[i].in = ref[i];
+    keys[i].out = (i % 3 == 0) ? ref[i] : dst[i];
+  }
+  ref[5][0] ^= 0x01;
+  ref[9][keys[9].nbytes] ^= 0x80;
+
+  assert(keyunwrap_batch(&ctx_simd, keys, NKEYS) == -1);
+
+  for (i = 0; i < NKEYS; i++) {
+    if (i == 5 || i == 9) {
+      assert(keys[i].status == -1);
+      for (j = 0; j < keys[i].nbytes; j++)
+	assert(((uint8_t *)keys[i].out)[j] == 0);
+      continue;
+    }
+
+    assert(keys[i].status == 0);
+    assert(memcmp(keys[i].out, src[i], keys[i].nbytes) == 0);
+  }
+
+  /* Keys with invalid key data length are rejected without touching output,
+   * valid key in same batch is processed normally. */
+  for (i = 0; i < 4; i++) {
+    static const size_t nbytes[4] = { 0, 8, 20, 24 };
+
+    memset(dst[i], 0x55, sizeof(dst[i]));
+    keys[i].in = src[i];
+    keys[i].out = dst[i];
+    keys[i].nbytes = nbytes[i];
+    keys[i].status = 0;
+  }
+  Camellia_keywrap(src[3], ref[3], 24, &ctx_ref);
+
+  keywrap_batch(&ctx_simd, keys, 4);
+
+  for (i = 0; i < 3; i++) {
+    assert(keys[i].status == -1);
+    for (j = 0; j < sizeof(dst[i]); j++)
+      assert(dst[i][j] == 0x55);
+  }
+  assert(keys[3].status == 0);
+  assert(memcmp(dst[3], ref[3], 24 + 8) == 0);
+
+  keys[3].in = ref[3];
+  keys[3].out = ref[3];
+  for (i = 0; i < 4; i++)
+    keys[i].status = 0;
+
+  assert(keyunwrap_batch(&ctx_simd, keys, 4) == -1);
+
+  for (i = 0; i < 3; i++) {
+    assert(keys[i].status == -1);
+    for (j = 0; j < sizeof(dst[i]); j++)
+      assert(dst[i][j] == 0x55);
+  }
+  assert(keys[3].status == 0);
+  assert(memcmp(ref[3], src[3], 24) == 0);
+}
+
+static void do_selftest(void)
+{
+  struct camellia_simd_ctx ctx_simd;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  uint8_t key[32];
+  uint8_t tmp[64 * 16];
+  uint8_t plaintext_simd[64 * 16];
+  uint8_t ref_large_plaintext[32 * 16];
+  uint8_t ref_large_ciphertext_128[32 * 16];
+  uint8_t ref_large_ciphertext_256[32 * 16];
+  unsigned int i, j;
+
+  /* Check test vectors against reference implementation. */
+  printf("selftest: comparing camellia-%d test vectors against reference implementation...\n", 128);
+  Camellia_set_key(test_vector_key_128, 128, &ctx_ref);
+  Camellia_encrypt(test_vector_plaintext, tmp, &ctx_ref);
+  assert(memcmp(tmp, test_vector_ciphertext_128, 16) == 0);
+  Camellia_decrypt(tmp, tmp, &ctx_ref);
+  assert(memcmp(tmp, test_vector_plaintext, 16) == 0);
+
+  printf("selftest: comparing camellia-%d test vectors against reference implementation...\n", 192);
+  Camellia_set_key(test_vector_key_192, 192, &ctx_ref);
+  Camellia_encrypt(test_vector_plaintext, tmp, &ctx_ref);
+  assert(memcmp(tmp, test_vector_ciphertext_192, 16) == 0);
+  Camellia_decrypt(tmp, tmp, &ctx_ref);
+  assert(memcmp(tmp, test_vector_plaintext, 16) == 0);
+
+  printf("selftest: comparing camellia-%d test vectors against reference implementation...\n", 256);
+  Camellia_set_key(test_vector_key_256, 256, &ctx_ref);
+  Camellia_encrypt(test_vector_plaintext, tmp, &ctx_ref);
+  assert(memcmp(tmp, test_vector_ciphertext_256, 16) == 0);
+  Camellia_decrypt(tmp, tmp, &ctx_ref);
+  assert(memcmp(tmp, test_vector_plaintext, 16) == 0);
+
+  /* Check 16-block SIMD128 implementation against known test vectors. */
+  printf("selftest: checking 16-block parallel camellia-128/SIMD128 against test vectors...\n");
+  fill_blks(plaintext_simd, test_vector_plaintext, 16);
+
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  camellia_encrypt_16blks_simd128(&ctx_simd, tmp, plaintext_simd);
+
+  for (i = 0; i < 16; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_128, 16) == 0);
+  }
+  camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 16 * 16) == 0);
+
+  printf("selftest: checking 16-block parallel camellia-192/SIMD128 against test vectors...\n");
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_192, 192 / 8);
+  camellia_encrypt_16blks_simd128(&ctx_simd, tmp, plaintext_simd);
+  for (i = 0; i < 16; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_192, 16) == 0);
+  }
+  camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 16 * 16) == 0);
+
+  printf("selftest: checking 16-block parallel camellia-256/SIMD128 against test vectors...\n");
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_256, 256 / 8);
+  camellia_encrypt_16blks_simd128(&ctx_simd, tmp, plaintext_simd);
+  for (i = 0; i < 16; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_256, 16) == 0);
+  }
+  camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 16 * 16) == 0);
+
+#ifdef USE_SIMD256
+  /* Check 32-block SIMD256 implementation against known test vectors. */
+  printf("selftest: checking 32-block parallel camellia-128/SIMD256 against test vectors...\n");
+  fill_blks(plaintext_simd, test_vector_plaintext, 32);
+
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  camellia_encrypt_32blks_simd256(&ctx_simd, tmp, plaintext_simd);
+
+  for (i = 0; i < 32; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_128, 16) == 0);
+  }
+  camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 32 * 16) == 0);
+
+  printf("selftest: checking 32-block parallel camellia-192/SIMD256 against test vectors...\n");
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_192, 192 / 8);
+  camellia_encrypt_32blks_simd256(&ctx_simd, tmp, plaintext_simd);
+  for (i = 0; i < 32; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_192, 16) == 0);
+  }
+  camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 32 * 16) == 0);
+
+  printf("selftest: checking 32-block parallel camellia-256/SIMD256 against test vectors...\n");
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_256, 256 / 8);
+  camellia_encrypt_32blks_simd256(&ctx_simd, tmp, plaintext_simd);
+  for (i = 0; i < 32; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_256, 16) == 0);
+  }
+  camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 32 * 16) == 0);
+#endif
+
+#ifdef USE_SIMD512
+  /* Check 64-block SIMD512 implementation against known test vectors. */
+  printf("selftest: checking 64-block parallel camellia-128/SIMD512 against test vectors...\n");
+  fill_blks(plaintext_simd, test_vector_plaintext, 64);
+
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  camellia_encrypt_64blks_simd512(&ctx_simd, tmp, plaintext_simd);
+
+  for (i = 0; i < 64; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_128, 16) == 0);
+  }
+  camellia_decrypt_64blks_simd512(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 64 * 16) == 0);
+
+  printf("selftest: checking 64-block parallel camellia-192/SIMD512 against test vectors...\n");
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_192, 192 / 8);
+  camellia_encrypt_64blks_simd512(&ctx_simd, tmp, plaintext_simd);
+  for (i = 0; i < 64; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_192, 16) == 0);
+  }
+  camellia_decrypt_64blks_simd512(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 64 * 16) == 0);
+
+  printf("selftest: checking 64-block parallel camellia-256/SIMD512 against test vectors...\n");
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_256, 256 / 8);
+  camellia_encrypt_64blks_simd512(&ctx_simd, tmp, plaintext_simd);
+  for (i = 0; i < 64; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_256, 16) == 0);
+  }
+  camellia_decrypt_64blks_simd512(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 64 * 16) == 0);
+#endif
+
+#ifdef USE_SIMD256_EVEX
+  /* Check 32-block register-resident EVEX implementation against known test
+   * vectors. */
+  printf("selftest: checking 32-block parallel camellia-128/SIMD256-EVEX against test vectors...\n");
+  fill_blks(plaintext_simd, test_vector_plaintext, 32);
+
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  camellia_encrypt_32blks_simd256_evex(&ctx_simd, tmp, plaintext_simd);
+  for (i = 0; i < 32; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_128, 16) == 0);
+  }
+  camellia_decrypt_32blks_simd256_evex(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 32 * 16) == 0);
+
+  printf("selftest: checking 32-block parallel camellia-192/SIMD256-EVEX against test vectors...\n");
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_192, 192 / 8);
+  camellia_encrypt_32blks_simd256_evex(&ctx_simd, tmp, plaintext_simd);
+  for (i = 0; i < 32; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_192, 16) == 0);
+  }
+  camellia_decrypt_32blks_simd256_evex(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 32 * 16) == 0);
+
+  printf("selftest: checking 32-block parallel camellia-256/SIMD256-EVEX against test vectors...\n");
+  memset(tmp, 0xaa, sizeof(tmp));
+  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_256, 256 / 8);
+  camellia_encrypt_32blks_simd256_evex(&ctx_simd, tmp, plaintext_simd);
+  for (i = 0; i < 32; i++) {
+    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_256, 16) == 0);
+  }
+  camellia_decrypt_32blks_simd256_evex(&ctx_simd, tmp, tmp);
+  assert(memcmp(tmp, plaintext_simd, 32 * 16) == 0);
+#endif
+
+  /* Generate large test vectors. */
+  for (i = 0; i < sizeof(key); i++)
+    key[i] = ((i + 1231) * 3221) & 0xff;
+  for (i = 0; i < sizeof(ref_large_plaintext); i++)
+    ref_large_plaintext[i] = ((i + 3221) * 1231) & 0xff;
+  Camellia_set_key(key, 128, &ctx_ref);
+  for (i = 0; i < 32; i++) {
+    Camellia_encrypt(&ref_large_plaintext[i * 16],
+		     &ref_large_ciphertext_128[i * 16], &ctx_ref);
+    for (j = 1; j < (1 << 16); j++) {
+      Camellia_encrypt(&ref_large_ciphertext_128[i * 16],
+		       &ref_large_ciphertext_128[i * 16], &ctx_ref);
+    }
+  }
+  Camellia_set_key(key, 256, &ctx_ref);
+  for (i = 0; i < 32; i++) {
+    Camellia_encrypt(&ref_large_plaintext[i * 16],
+		     &ref_large_ciphertext_256[i * 16], &ctx_ref);
+    for (j = 1; j < (1 << 16); j++) {
+      Camellia_encrypt(&ref_large_ciphertext_256[i * 16],
+		       &ref_large_ciphertext_256[i * 16], &ctx_ref);
+    }
+  }
+
+  /* Test 16-block SIMD128 implementation against large test vectors. */
+  printf("selftest: checking 16-block parallel camellia-128/SIMD128 against large test vectors...\n");
+  camellia_keysetup_simd128(&ctx_simd, key, 128 / 8);
+  memcpy(tmp, ref_large_plaintext, 16 * 16);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_encrypt_16blks_simd128(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_ciphertext_128, 16 * 16) == 0);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_plaintext, 16 * 16) == 0);
+
+  printf("selftest: checking 16-block parallel camellia-256/SIMD128 against large test vectors...\n");
+  camellia_keysetup_simd128(&ctx_simd, key, 256 / 8);
+  memcpy(tmp, ref_large_plaintext, 16 * 16);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_encrypt_16blks_simd128(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_ciphertext_256, 16 * 16) == 0);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_plaintext, 16 * 16) == 0);
+
+  /* Test 1/2/4-block SIMD128 implementations against reference. */
+  selftest_blks1_4(key, 128);
+  selftest_blks1_4(key, 192);
+  selftest_blks1_4(key, 256);
+
+#ifdef USE_SIMD256
+  /* Test 32-block SIMD256 implementation against large test vectors. */
+  printf("selftest: checking 32-block parallel camellia-128/SIMD256 against large test vectors...\n");
+  camellia_keysetup_simd128(&ctx_simd, key, 128 / 8);
+  memcpy(tmp, ref_large_plaintext, 32 * 16);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_encrypt_32blks_simd256(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_ciphertext_128, 32 * 16) == 0);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_plaintext, 32 * 16) == 0);
+
+  printf("selftest: checking 32-block parallel camellia-256/SIMD256 against large test vectors...\n");
+  camellia_keysetup_simd128(&ctx_simd, key, 256 / 8);
+  memcpy(tmp, ref_large_plaintext, 32 * 16);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_encrypt_32blks_simd256(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_ciphertext_256, 32 * 16) == 0);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_plaintext, 32 * 16) == 0);
+#endif
+
+#ifdef USE_SIMD512
+  /* Test 64-block SIMD512 implementation against large test vectors, using
+   * two copies of the 32 block vectors. */
+  printf("selftest: checking 64-block parallel camellia-128/SIMD512 against large test vectors...\n");
+  camellia_keysetup_simd128(&ctx_simd, key, 128 / 8);
+  memcpy(&tmp[0 * 16], ref_large_plaintext, 32 * 16);
+  memcpy(&tmp[32 * 16], ref_large_plaintext, 32 * 16);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_encrypt_64blks_simd512(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(&tmp[0 * 16], ref_large_ciphertext_128, 32 * 16) == 0);
+  assert(memcmp(&tmp[32 * 16], ref_large_ciphertext_128, 32 * 16) == 0);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_decrypt_64blks_simd512(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(&tmp[0 * 16], ref_large_plaintext, 32 * 16) == 0);
+  assert(memcmp(&tmp[32 * 16], ref_large_plaintext, 32 * 16) == 0);
+
+  printf("selftest: checking 64-block parallel camellia-256/SIMD512 against large test vectors...\n");
+  camellia_keysetup_simd128(&ctx_simd, key, 256 / 8);
+  memcpy(&tmp[0 * 16], ref_large_plaintext, 32 * 16);
+  memcpy(&tmp[32 * 16], ref_large_plaintext, 32 * 16);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_encrypt_64blks_simd512(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(&tmp[0 * 16], ref_large_ciphertext_256, 32 * 16) == 0);
+  assert(memcmp(&tmp[32 * 16], ref_large_ciphertext_256, 32 * 16) == 0);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_decrypt_64blks_simd512(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(&tmp[0 * 16], ref_large_plaintext, 32 * 16) == 0);
+  assert(memcmp(&tmp[32 * 16], ref_large_plaintext, 32 * 16) == 0);
+#endif
+
+#ifdef USE_SIMD256_EVEX
+  /* Test 32-block register-resident EVEX implementation against large test
+   * vectors. */
+  printf("selftest: checking 32-block parallel camellia-128/SIMD256-EVEX against large test vectors...\n");
+  camellia_keysetup_simd128(&ctx_simd, key, 128 / 8);
+  memcpy(tmp, ref_large_plaintext, 32 * 16);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_encrypt_32blks_simd256_evex(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_ciphertext_128, 32 * 16) == 0);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_decrypt_32blks_simd256_evex(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_plaintext, 32 * 16) == 0);
+
+  printf("selftest: checking 32-block parallel camellia-256/SIMD256-EVEX against large test vectors...\n");
+  camellia_keysetup_simd128(&ctx_simd, key, 256 / 8);
+  memcpy(tmp, ref_large_plaintext, 32 * 16);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_encrypt_32blks_simd256_evex(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_ciphertext_256, 32 * 16) == 0);
+  for (i = 0; i < (1 << 16); i++) {
+    camellia_decrypt_32blks_simd256_evex(&ctx_simd, tmp, tmp);
+  }
+  assert(memcmp(tmp, ref_large_plaintext, 32 * 16) == 0);
+#endif
+
+  /* Check modes of operation against reference implementation. */
+  selftest_ecb_blocks("SIMD128", camellia_encrypt_blocks_simd128,
+		      camellia_decrypt_blocks_simd128, key, 128);
+  selftest_ecb_blocks("SIMD128", camellia_encrypt_blocks_simd128,
+		      camellia_decrypt_blocks_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_ecb_blocks("SIMD256", camellia_encrypt_blocks_simd256,
+		      camellia_decrypt_blocks_simd256, key, 128);
+  selftest_ecb_blocks("SIMD256", camellia_encrypt_blocks_simd256,
+		      camellia_decrypt_blocks_simd256, key, 256);
+#endif
+#ifdef USE_SIMD512
+  selftest_ecb_blocks("SIMD512", camellia_encrypt_blocks_simd512,
+		      camellia_decrypt_blocks_simd512, key, 128);
+  selftest_ecb_blocks("SIMD512", camellia_encrypt_blocks_simd512,
+		      camellia_decrypt_blocks_simd512, key, 256);
+#endif
+  selftest_ctr("SIMD128", camellia_ctr_encrypt_simd128, key, 128);
+  selftest_ctr("SIMD128", camellia_ctr_encrypt_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_ctr("SIMD256", camellia_ctr_encrypt_simd256, key, 128);
+  selftest_ctr("SIMD256", camellia_ctr_encrypt_simd256, key, 256);
+#endif
+  selftest_cbc_dec("SIMD128", camellia_cbc_decrypt_simd128, key, 128);
+  selftest_cbc_dec("SIMD128", camellia_cbc_decrypt_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_cbc_dec("SIMD256", camellia_cbc_decrypt_simd256, key, 128);
+  selftest_cbc_dec("SIMD256", camellia_cbc_decrypt_simd256, key, 256);
+#endif
+  selftest_cfb_dec("SIMD128", camellia_cfb_decrypt_simd128, key, 128);
+  selftest_cfb_dec("SIMD128", camellia_cfb_decrypt_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_cfb_dec("SIMD256", camellia_cfb_decrypt_simd256, key, 128);
+  selftest_cfb_dec("SIMD256", camellia_cfb_decrypt_simd256, key, 256);
+#endif
+  selftest_xts("SIMD128", camellia_xts_encrypt_simd128,
+	       camellia_xts_decrypt_simd128, key, 128);
+  selftest_xts("SIMD128", camellia_xts_encrypt_simd128,
+	       camellia_xts_decrypt_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_xts("SIMD256", camellia_xts_encrypt_simd256,
+	       camellia_xts_decrypt_simd256, key, 128);
+  selftest_xts("SIMD256", camellia_xts_encrypt_simd256,
+	       camellia_xts_decrypt_simd256, key, 256);
+#endif
+  selftest_cbc_enc_multi("SIMD128", camellia_cbc_encrypt_multi_simd128, key,
+			 128);
+  selftest_cbc_enc_multi("SIMD128", camellia_cbc_encrypt_multi_simd128, key,
+			 256);
+#ifdef USE_SIMD256
+  selftest_cbc_enc_multi("SIMD256", camellia_cbc_encrypt_multi_simd256, key,
+			 128);
+  selftest_cbc_enc_multi("SIMD256", camellia_cbc_encrypt_multi_simd256, key,
+			 256);
+#endif
+  selftest_ocb("SIMD128", camellia_ocb_encrypt_simd128,
+	       camellia_ocb_decrypt_simd128, key, 128);
+  selftest_ocb("SIMD128", camellia_ocb_encrypt_simd128,
+	       camellia_ocb_decrypt_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_ocb("SIMD256", camellia_ocb_encrypt_simd256,
+	       camellia_ocb_decrypt_simd256, key, 128);
+  selftest_ocb("SIMD256", camellia_ocb_encrypt_simd256,
+	       camellia_ocb_decrypt_simd256, key, 256);
+#endif
+  selftest_gcm("SIMD128", camellia_gcm_encrypt_simd128,
+	       camellia_gcm_decrypt_simd128, key, 128);
+  selftest_gcm("SIMD128", camellia_gcm_encrypt_simd128,
+	       camellia_gcm_decrypt_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_gcm("SIMD256", camellia_gcm_encrypt_simd256,
+	       camellia_gcm_decrypt_simd256, key, 128);
+  selftest_gcm("SIMD256", camellia_gcm_encrypt_simd256,
+	       camellia_gcm_decrypt_simd256, key, 256);
+#endif
+  selftest_gcm_siv("SIMD128", camellia_gcm_siv_encrypt_simd128,
+		   camellia_gcm_siv_decrypt_simd128, key, 128);
+  selftest_gcm_siv("SIMD128", camellia_gcm_siv_encrypt_simd128,
+		   camellia_gcm_siv_decrypt_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_gcm_siv("SIMD256", camellia_gcm_siv_encrypt_simd256,
+		   camellia_gcm_siv_decrypt_simd256, key, 128);
+  selftest_gcm_siv("SIMD256", camellia_gcm_siv_encrypt_simd256,
+		   camellia_gcm_siv_decrypt_simd256, key, 256);
+#endif
+  selftest_ccm_multi("SIMD128", camellia_ccm_encrypt_multi_simd128,
+		     camellia_ccm_decrypt_multi_simd128, key, 128);
+  selftest_ccm_multi("SIMD128", camellia_ccm_encrypt_multi_simd128,
+		     camellia_ccm_decrypt_multi_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_ccm_multi("SIMD256", camellia_ccm_encrypt_multi_simd256,
+		     camellia_ccm_decrypt_multi_simd256, key, 128);
+  selftest_ccm_multi("SIMD256", camellia_ccm_encrypt_multi_simd256,
+		     camellia_ccm_decrypt_multi_simd256, key, 256);
+#endif
+  selftest_cmac_batch("SIMD128", camellia_cmac_batch_simd128,
+		      camellia_cmac_verify_batch_simd128, key, 128);
+  selftest_cmac_batch("SIMD128", camellia_cmac_batch_simd128,
+		      camellia_cmac_verify_batch_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_cmac_batch("SIMD256", camellia_cmac_batch_simd256,
+		      camellia_cmac_verify_batch_simd256, key, 128);
+  selftest_cmac_batch("SIMD256", camellia_cmac_batch_simd256,
+		      camellia_cmac_verify_batch_simd256, key, 256);
+#endif
+  selftest_siv_multi("SIMD128", camellia_siv_encrypt_multi_simd128,
+		     camellia_siv_decrypt_multi_simd128, key, 128);
+  selftest_siv_multi("SIMD128", camellia_siv_encrypt_multi_simd128,
+		     camellia_siv_decrypt_multi_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_siv_multi("SIMD256", camellia_siv_encrypt_multi_simd256,
+		     camellia_siv_decrypt_multi_simd256, key, 128);
+  selftest_siv_multi("SIMD256", camellia_siv_encrypt_multi_simd256,
+		     camellia_siv_decrypt_multi_simd256, key, 256);
+#endif
+  selftest_keywrap_batch("SIMD128", camellia_keywrap_batch_simd128,
+			 camellia_keyunwrap_batch_simd128, key, 128);
+  selftest_keywrap_batch("SIMD128", camellia_keywrap_batch_simd128,
+			 camellia_keyunwrap_batch_simd128, key, 256);
+#ifdef USE_SIMD256
+  selftest_keywrap_batch("SIMD256", camellia_keywrap_batch_simd256,
+			 camellia_keyunwrap_batch_simd256, key, 128);
+  selftest_keywrap_batch("SIMD256", camellia_keywrap_batch_simd256,
+			 camellia_keyunwrap_batch_simd256, key, 256);
+#endif
+}
+
+static uint64_t curr_clock_nsecs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+static void print_result(const char *variant, uint64_t num_bytes,
+			 uint64_t elapsed_nsecs)
+{
+  double mebi_per_sec, mega_per_sec;
+
+  mebi_per_sec = num_bytes * 1e9 / (1024.0 * 1024 * elapsed_nsecs);
+  mega_per_sec = num_bytes * 1e9 / (1e6 * elapsed_nsecs);
+  printf("%44s: %10.3f Mebibytes/s, %10.3f Megabytes/s\n",
+	 variant, mebi_per_sec, mega_per_sec);
+  fflush(stdout);
+}
+
+static void do_speedtest(void)
+{
+  const uint64_t test_nsecs = 1ULL * 1000 * 1000 * 1000;
+  struct camellia_simd_ctx ctx_simd;
+  static struct camellia_ocb_ctx ctx_ocb;
+  static struct camellia_gcm_ctx ctx_gcm;
+  static struct camellia_gcm_siv_ctx ctx_gcm_siv;
+  static struct camellia_cmac_ctx ctx_cmac;
+  static struct camellia_siv_ctx ctx_siv;
+  CAMELLIA_KEY ctx_ref = { 0 };
+  uint8_t tmp[16 * 32 * 16] __attribute__((aligned(64)));
+  uint8_t iv[16];
+  uint8_t tag[16];
+  struct camellia_cbc_stream streams[32];
+  struct camellia_ccm_msg msgs[32];
+  const void *cmac_msgs[sizeof(tmp) / 64];
+  size_t cmac_lens[sizeof(tmp) / 64];
+  uint8_t cmac_tags[sizeof(tmp) / 64][16];
+  static struct camellia_siv_msg siv_msgs[sizeof(tmp) / 64];
+  uint8_t siv_key[32];
+  static struct camellia_keywrap_key keywrap_keys[sizeof(tmp) / 64];
+  uint64_t start_time;
+  uint64_t end_time;
+  uint64_t total_bytes;
+  unsigned int i, j;
+
+  for (i = 0; i < sizeof(tmp); i++)
+    tmp[i] = ((i + 3221) * 1231) & 0xff;
+
+  /* Test speed of reference implementation. */
+  total_bytes = 0;
+  Camellia_set_key(test_vector_key_128, 128, &ctx_ref);
+
+  start_time = curr_clock_nsecs();
+  do {
+    Camellia_encrypt_nblks(tmp, tmp, sizeof(tmp) / 16, &ctx_ref);
+    total_bytes += sizeof(tmp) - sizeof(tmp) % 16;
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 reference encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  Camellia_set_key(test_vector_key_128, 128, &ctx_ref);
+
+  start_time = curr_clock_nsecs();
+  do {
+    Camellia_decrypt_nblks(tmp, tmp, sizeof(tmp) / 16, &ctx_ref);
+    total_bytes += sizeof(tmp) - sizeof(tmp) % 16;
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 reference decryption",
+	       total_bytes, end_time - start_time);
+
+  /* Test speed of 16-block SIMD128 implementation. */
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  start_time = curr_clock_nsecs();
+  do {
+    for (j = 0; j < sizeof(tmp); ) {
+      camellia_encrypt_16blks_simd128(&ctx_simd, &tmp[j], &tmp[j]);
+      j += 16 * 16;
+      total_bytes += 16 * 16;
+    }
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 (16 blocks) encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  start_time = curr_clock_nsecs();
+  do {
+    for (j = 0; j < sizeof(tmp); ) {
+      camellia_decrypt_16blks_simd128(&ctx_simd, &tmp[j], &tmp[j]);
+      j += 16 * 16;
+      total_bytes += 16 * 16;
+    }
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 (16 blocks) decryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  start_time = curr_clock_nsecs();
+  do {
+    for (j = 0; j + 16 <= sizeof(tmp); ) {
+      camellia_encrypt_1blk_simd128(&ctx_simd, &tmp[j], &tmp[j]);
+      j += 16;
+      total_bytes += 16;
+    }
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 (1 block) encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  start_time = curr_clock_nsecs();
+  do {
+    for (j = 0; j + 2 * 16 <= sizeof(tmp); ) {
+      camellia_encrypt_2blks_simd128(&ctx_simd, &tmp[j], &tmp[j]);
+      j += 2 * 16;
+      total_bytes += 2 * 16;
+    }
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 (2 blocks) encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  start_time = curr_clock_nsecs();
+  do {
+    for (j = 0; j + 3 * 16 <= sizeof(tmp); ) {
+      camellia_encrypt_nblks_simd128(&ctx_simd, &tmp[j], &tmp[j], 3);
+      j += 3 * 16;
+      total_bytes += 3 * 16;
+    }
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 (3 blocks) encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  start_time = curr_clock_nsecs();
+  do {
+    for (j = 0; j + 4 * 16 <= sizeof(tmp); ) {
+      camellia_encrypt_4blks_simd128(&ctx_simd, &tmp[j], &tmp[j]);
+      j += 4 * 16;
+      total_bytes += 4 * 16;
+    }
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 (4 blocks) encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ctr_encrypt_simd128(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 CTR encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_cbc_decrypt_simd128(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 CBC decryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_cfb_decrypt_simd128(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 CFB decryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_xts_encrypt_simd128(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 XTS encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_xts_decrypt_simd128(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 XTS decryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  for (i = 0; i < 32; i++) {
+    streams[i].out = &tmp[i * sizeof(tmp) / 32];
+    streams[i].in = &tmp[i * sizeof(tmp) / 32];
+    streams[i].nbytes = sizeof(tmp) / 32;
+    memset(streams[i].iv, 0, 16);
+  }
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_cbc_encrypt_multi_simd128(&ctx_simd, streams, 32);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 CBC-enc (32 streams)",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(msgs, 0, sizeof(msgs));
+  for (i = 0; i < 32; i++) {
+    msgs[i].out = &tmp[i * sizeof(tmp) / 32];
+    msgs[i].in = &tmp[i * sizeof(tmp) / 32];
+    msgs[i].nbytes = sizeof(tmp) / 32;
+    msgs[i].noncelen = 11;
+    msgs[i].taglen = 16;
+  }
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ccm_encrypt_multi_simd128(&ctx_simd, msgs, 32);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 CCM-enc (32 messages)",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ccm_decrypt_multi_simd128(&ctx_simd, msgs, 32);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 CCM-dec (32 messages)",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_cmac_keysetup_simd128(&ctx_cmac, test_vector_key_128, 128 / 8);
+  for (i = 0; i < sizeof(tmp) / 64; i++) {
+    cmac_msgs[i] = &tmp[i * 64];
+    cmac_lens[i] = 64;
+  }
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_cmac_batch_simd128(&ctx_cmac, cmac_msgs, cmac_lens, cmac_tags,
+			       sizeof(tmp) / 64);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 CMAC (64 byte msgs)",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  memcpy(siv_key, test_vector_key_128, 16);
+  memcpy(siv_key + 16, test_vector_key_128, 16);
+  camellia_siv_keysetup_simd128(&ctx_siv, siv_key, 32);
+  memset(siv_msgs, 0, sizeof(siv_msgs));
+  for (i = 0; i < sizeof(tmp) / 64; i++) {
+    siv_msgs[i].out = &tmp[i * 64];
+    siv_msgs[i].in = &tmp[i * 64];
+    siv_msgs[i].nbytes = 40;
+  }
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_siv_encrypt_multi_simd128(&ctx_siv, siv_msgs, sizeof(tmp) / 64);
+    total_bytes += sizeof(tmp) / 64 * 40;
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 SIV-enc (40 byte msgs)",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  for (i = 0; i < sizeof(tmp) / 64; i++) {
+    keywrap_keys[i].out = &tmp[i * 64];
+    keywrap_keys[i].in = &tmp[i * 64];
+    keywrap_keys[i].nbytes = 32;
+  }
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_keywrap_batch_simd128(&ctx_simd, keywrap_keys, sizeof(tmp) / 64);
+    total_bytes += sizeof(tmp) / 64 * 32;
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 keywrap (32 byte keys)",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_ocb_keysetup_simd128(&ctx_ocb, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ocb_encrypt_simd128(&ctx_ocb, tmp, tmp, sizeof(tmp), iv, 12,
+				 NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 OCB encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_ocb_keysetup_simd128(&ctx_ocb, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ocb_decrypt_simd128(&ctx_ocb, tmp, tmp, sizeof(tmp), iv, 12,
+				 NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 OCB decryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_gcm_keysetup_simd128(&ctx_gcm, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_gcm_encrypt_simd128(&ctx_gcm, tmp, tmp, sizeof(tmp), iv, 12,
+				 NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 GCM encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_gcm_keysetup_simd128(&ctx_gcm, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_gcm_decrypt_simd128(&ctx_gcm, tmp, tmp, sizeof(tmp), iv, 12,
+				 NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 GCM decryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_gcm_siv_keysetup_simd128(&ctx_gcm_siv, test_vector_key_128,
+				    128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_gcm_siv_encrypt_simd128(&ctx_gcm_siv, tmp, tmp, sizeof(tmp), iv,
+				     NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 GCM-SIV encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_gcm_siv_keysetup_simd128(&ctx_gcm_siv, test_vector_key_128,
+				    128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_gcm_siv_decrypt_simd128(&ctx_gcm_siv, tmp, tmp, sizeof(tmp), iv,
+				     NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD128 GCM-SIV decryption",
+	       total_bytes, end_time - start_time);
+
+#ifdef USE_SIMD256
+  /* Test speed of 32-block SIMD256 implementation. */
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  start_time = curr_clock_nsecs();
+  do {
+    for (j = 0; j < sizeof(tmp); ) {
+      camellia_encrypt_32blks_simd256(&ctx_simd, &tmp[j], &tmp[j]);
+      j += 32 * 16;
+      total_bytes += 32 * 16;
+    }
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 (32 blocks) encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  start_time = curr_clock_nsecs();
+  do {
+    for (j = 0; j < sizeof(tmp); ) {
+      camellia_decrypt_32blks_simd256(&ctx_simd, &tmp[j], &tmp[j]);
+      j += 32 * 16;
+      total_bytes += 32 * 16;
+    }
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 (32 blocks) decryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+
+  start_time = curr_clock_nsecs();
+  do {
+    for (j = 0; j + 3 * 16 <= sizeof(tmp); ) {
+      camellia_encrypt_nblks_simd256(&ctx_simd, &tmp[j], &tmp[j], 3);
+      j += 3 * 16;
+      total_bytes += 3 * 16;
+    }
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 (3 blocks) encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ctr_encrypt_simd256(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 CTR encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_cbc_decrypt_simd256(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 CBC decryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_cfb_decrypt_simd256(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 CFB decryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_xts_encrypt_simd256(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 XTS encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_xts_decrypt_simd256(&ctx_simd, tmp, tmp, sizeof(tmp), iv);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 XTS decryption",
+	       total_bytes, end_time - start_time);
 
-  memset(tmp, 0xaa, sizeof(tmp));
-  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
+  total_bytes = 0;
   camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  for (i = 0; i < 32; i++) {
+    streams[i].out = &tmp[i * sizeof(tmp) / 32];
+    streams[i].in = &tmp[i * sizeof(tmp) / 32];
+    streams[i].nbytes = sizeof(tmp) / 32;
+    memset(streams[i].iv, 0, 16);
+  }
 
-  camellia_encrypt_16blks_simd128(&ctx_simd, tmp, plaintext_simd);
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_cbc_encrypt_multi_simd256(&ctx_simd, streams, 32);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
 
-  for (i = 0; i < 16; i++) {
-    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_128, 16) == 0);
-  }
-  camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
-  assert(memcmp(tmp, plaintext_simd, 16 * 16) == 0);
+  print_result("camellia-128 SIMD256 CBC-enc (32 streams)",
+	       total_bytes, end_time - start_time);
 
-  printf("selftest: checking 16-block parallel camellia-192/SIMD128 against test vectors...\n");
-  memset(tmp, 0xaa, sizeof(tmp));
-  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
-  camellia_keysetup_simd128(&ctx_simd, test_vector_key_192, 192 / 8);
-  camellia_encrypt_16blks_simd128(&ctx_simd, tmp, plaintext_simd);
-  for (i = 0; i < 16; i++) {
-    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_192, 16) == 0);
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  memset(msgs, 0, sizeof(msgs));
+  for (i = 0; i < 32; i++) {
+    msgs[i].out = &tmp[i * sizeof(tmp) / 32];
+    msgs[i].in = &tmp[i * sizeof(tmp) / 32];
+    msgs[i].nbytes = sizeof(tmp) / 32;
+    msgs[i].noncelen = 11;
+    msgs[i].taglen = 16;
   }
-  camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
-  assert(memcmp(tmp, plaintext_simd, 16 * 16) == 0);
 
-  printf("selftest: checking 16-block parallel camellia-256/SIMD128 against test vectors...\n");
-  memset(tmp, 0xaa, sizeof(tmp));
-  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
-  camellia_keysetup_simd128(&ctx_simd, test_vector_key_256, 256 / 8);
-  camellia_encrypt_16blks_simd128(&ctx_simd, tmp, plaintext_simd);
-  for (i = 0; i < 16; i++) {
-    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_256, 16) == 0);
-  }
-  camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
-  assert(memcmp(tmp, plaintext_simd, 16 * 16) == 0);
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ccm_encrypt_multi_simd256(&ctx_simd, msgs, 32);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
 
-#ifdef USE_SIMD256
-  /* Check 32-block SIMD256 implementation against known test vectors. */
-  printf("selftest: checking 32-block parallel camellia-128/SIMD256 against test vectors...\n");
-  fill_blks(plaintext_simd, test_vector_plaintext, 32);
+  print_result("camellia-128 SIMD256 CCM-enc (32 messages)",
+	       total_bytes, end_time - start_time);
 
-  memset(tmp, 0xaa, sizeof(tmp));
-  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
-  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  total_bytes = 0;
 
-  camellia_encrypt_32blks_simd256(&ctx_simd, tmp, plaintext_simd);
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ccm_decrypt_multi_simd256(&ctx_simd, msgs, 32);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
 
-  for (i = 0; i < 32; i++) {
-    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_128, 16) == 0);
-  }
-  camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
-  assert(memcmp(tmp, plaintext_simd, 32 * 16) == 0);
+  print_result("camellia-128 SIMD256 CCM-dec (32 messages)",
+	       total_bytes, end_time - start_time);
 
-  printf("selftest: checking 32-block parallel camellia-192/SIMD256 against test vectors...\n");
-  memset(tmp, 0xaa, sizeof(tmp));
-  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
-  camellia_keysetup_simd128(&ctx_simd, test_vector_key_192, 192 / 8);
-  camellia_encrypt_32blks_simd256(&ctx_simd, tmp, plaintext_simd);
-  for (i = 0; i < 32; i++) {
-    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_192, 16) == 0);
+  total_bytes = 0;
+  camellia_cmac_keysetup_simd128(&ctx_cmac, test_vector_key_128, 128 / 8);
+  for (i = 0; i < sizeof(tmp) / 64; i++) {
+    cmac_msgs[i] = &tmp[i * 64];
+    cmac_lens[i] = 64;
   }
-  camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
-  assert(memcmp(tmp, plaintext_simd, 32 * 16) == 0);
 
-  printf("selftest: checking 32-block parallel camellia-256/SIMD256 against test vectors...\n");
-  memset(tmp, 0xaa, sizeof(tmp));
-  memset(&ctx_simd, 0xff, sizeof(ctx_simd));
-  camellia_keysetup_simd128(&ctx_simd, test_vector_key_256, 256 / 8);
-  camellia_encrypt_32blks_simd256(&ctx_simd, tmp, plaintext_simd);
-  for (i = 0; i < 32; i++) {
-    assert(memcmp(&tmp[i * 16], test_vector_ciphertext_256, 16) == 0);
-  }
-  camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
-  assert(memcmp(tmp, plaintext_simd, 32 * 16) == 0);
-#endif
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_cmac_batch_simd256(&ctx_cmac, cmac_msgs, cmac_lens, cmac_tags,
+			       sizeof(tmp) / 64);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
 
-  /* Generate large test vectors. */
-  for (i = 0; i < sizeof(key); i++)
-    key[i] = ((i + 1231) * 3221) & 0xff;
-  for (i = 0; i < sizeof(ref_large_plaintext); i++)
-    ref_large_plaintext[i] = ((i + 3221) * 1231) & 0xff;
-  Camellia_set_key(key, 128, &ctx_ref);
-  for (i = 0; i < 32; i++) {
-    Camellia_encrypt(&ref_large_plaintext[i * 16],
-		     &ref_large_ciphertext_128[i * 16], &ctx_ref);
-    for (j = 1; j < (1 << 16); j++) {
-      Camellia_encrypt(&ref_large_ciphertext_128[i * 16],
-		       &ref_large_ciphertext_128[i * 16], &ctx_ref);
-    }
-  }
-  Camellia_set_key(key, 256, &ctx_ref);
-  for (i = 0; i < 32; i++) {
-    Camellia_encrypt(&ref_large_plaintext[i * 16],
-		     &ref_large_ciphertext_256[i * 16], &ctx_ref);
-    for (j = 1; j < (1 << 16); j++) {
-      Camellia_encrypt(&ref_large_ciphertext_256[i * 16],
-		       &ref_large_ciphertext_256[i * 16], &ctx_ref);
-    }
-  }
+  print_result("camellia-128 SIMD256 CMAC (64 byte msgs)",
+	       total_bytes, end_time - start_time);
 
-  /* Test 16-block SIMD128 implementation against large test vectors. */
-  printf("selftest: checking 16-block parallel camellia-128/SIMD128 against large test vectors...\n");
-  camellia_keysetup_simd128(&ctx_simd, key, 128 / 8);
-  memcpy(tmp, ref_large_plaintext, 16 * 16);
-  for (i = 0; i < (1 << 16); i++) {
-    camellia_encrypt_16blks_simd128(&ctx_simd, tmp, tmp);
-  }
-  assert(memcmp(tmp, ref_large_ciphertext_128, 16 * 16) == 0);
-  for (i = 0; i < (1 << 16); i++) {
-    camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
+  total_bytes = 0;
+  memcpy(siv_key, test_vector_key_128, 16);
+  memcpy(siv_key + 16, test_vector_key_128, 16);
+  camellia_siv_keysetup_simd128(&ctx_siv, siv_key, 32);
+  memset(siv_msgs, 0, sizeof(siv_msgs));
+  for (i = 0; i < sizeof(tmp) / 64; i++) {
+    siv_msgs[i].out = &tmp[i * 64];
+    siv_msgs[i].in = &tmp[i * 64];
+    siv_msgs[i].nbytes = 40;
   }
-  assert(memcmp(tmp, ref_large_plaintext, 16 * 16) == 0);
 
-  printf("selftest: checking 16-block parallel camellia-256/SIMD128 against large test vectors...\n");
-  camellia_keysetup_simd128(&ctx_simd, key, 256 / 8);
-  memcpy(tmp, ref_large_plaintext, 16 * 16);
-  for (i = 0; i < (1 << 16); i++) {
-    camellia_encrypt_16blks_simd128(&ctx_simd, tmp, tmp);
-  }
-  assert(memcmp(tmp, ref_large_ciphertext_256, 16 * 16) == 0);
-  for (i = 0; i < (1 << 16); i++) {
-    camellia_decrypt_16blks_simd128(&ctx_simd, tmp, tmp);
-  }
-  assert(memcmp(tmp, ref_large_plaintext, 16 * 16) == 0);
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_siv_encrypt_multi_simd256(&ctx_siv, siv_msgs, sizeof(tmp) / 64);
+    total_bytes += sizeof(tmp) / 64 * 40;
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
 
-#ifdef USE_SIMD256
-  /* Test 32-block SIMD256 implementation against large test vectors. */
-  printf("selftest: checking 32-block parallel camellia-128/SIMD256 against large test vectors...\n");
-  camellia_keysetup_simd128(&ctx_simd, key, 128 / 8);
-  memcpy(tmp, ref_large_plaintext, 32 * 16);
-  for (i = 0; i < (1 << 16); i++) {
-    camellia_encrypt_32blks_simd256(&ctx_simd, tmp, tmp);
-  }
-  assert(memcmp(tmp, ref_large_ciphertext_128, 32 * 16) == 0);
-  for (i = 0; i < (1 << 16); i++) {
-    camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
-  }
-  assert(memcmp(tmp, ref_large_plaintext, 32 * 16) == 0);
+  print_result("camellia-128 SIMD256 SIV-enc (40 byte msgs)",
+	       total_bytes, end_time - start_time);
 
-  printf("selftest: checking 32-block parallel camellia-256/SIMD256 against large test vectors...\n");
-  camellia_keysetup_simd128(&ctx_simd, key, 256 / 8);
-  memcpy(tmp, ref_large_plaintext, 32 * 16);
-  for (i = 0; i < (1 << 16); i++) {
-    camellia_encrypt_32blks_simd256(&ctx_simd, tmp, tmp);
-  }
-  assert(memcmp(tmp, ref_large_ciphertext_256, 32 * 16) == 0);
-  for (i = 0; i < (1 << 16); i++) {
-    camellia_decrypt_32blks_simd256(&ctx_simd, tmp, tmp);
+  total_bytes = 0;
+  camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
+  for (i = 0; i < sizeof(tmp) / 64; i++) {
+    keywrap_keys[i].out = &tmp[i * 64];
+    keywrap_keys[i].in = &tmp[i * 64];
+    keywrap_keys[i].nbytes = 32;
   }
-  assert(memcmp(tmp, ref_large_plaintext, 32 * 16) == 0);
-#endif
-}
 
-static uint64_t curr_clock_nsecs(void)
-{
-  struct timespec ts;
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_keywrap_batch_simd256(&ctx_simd, keywrap_keys, sizeof(tmp) / 64);
+    total_bytes += sizeof(tmp) / 64 * 32;
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
 
-  clock_gettime(CLOCK_MONOTONIC, &ts);
+  print_result("camellia-128 SIMD256 keywrap (32 byte keys)",
+	       total_bytes, end_time - start_time);
 
-  return (uint64_t)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
-}
+  total_bytes = 0;
+  camellia_ocb_keysetup_simd128(&ctx_ocb, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
 
-static void print_result(const char *variant, uint64_t num_bytes,
-			 uint64_t elapsed_nsecs)
-{
-  double mebi_per_sec, mega_per_sec;
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ocb_encrypt_simd256(&ctx_ocb, tmp, tmp, sizeof(tmp), iv, 12,
+				 NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
 
-  mebi_per_sec = num_bytes * 1e9 / (1024.0 * 1024 * elapsed_nsecs);
-  mega_per_sec = num_bytes * 1e9 / (1e6 * elapsed_nsecs);
-  printf("%44s: %10.3f Mebibytes/s, %10.3f Megabytes/s\n",
-	 variant, mebi_per_sec, mega_per_sec);
-  fflush(stdout);
-}
+  print_result("camellia-128 SIMD256 OCB encryption",
+	       total_bytes, end_time - start_time);
 
-static void do_speedtest(void)
-{
-  const uint64_t test_nsecs = 1ULL * 1000 * 1000 * 1000;
-  struct camellia_simd_ctx ctx_simd;
-  CAMELLIA_KEY ctx_ref = { 0 };
-  uint8_t tmp[16 * 32 * 16] __attribute__((aligned(64)));
-  uint64_t start_time;
-  uint64_t end_time;
-  uint64_t total_bytes;
-  unsigned int i, j;
+  total_bytes = 0;
+  camellia_ocb_keysetup_simd128(&ctx_ocb, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
 
-  for (i = 0; i < sizeof(tmp); i++)
-    tmp[i] = ((i + 3221) * 1231) & 0xff;
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_ocb_decrypt_simd256(&ctx_ocb, tmp, tmp, sizeof(tmp), iv, 12,
+				 NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 OCB decryption",
+	       total_bytes, end_time - start_time);
 
-  /* Test speed of reference implementation. */
   total_bytes = 0;
-  Camellia_set_key(test_vector_key_128, 128, &ctx_ref);
+  camellia_gcm_keysetup_simd128(&ctx_gcm, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
 
   start_time = curr_clock_nsecs();
   do {
-    Camellia_encrypt_nblks(tmp, tmp, sizeof(tmp) / 16, &ctx_ref);
-    total_bytes += sizeof(tmp) - sizeof(tmp) % 16;
+    camellia_gcm_encrypt_simd256(&ctx_gcm, tmp, tmp, sizeof(tmp), iv, 12,
+				 NULL, 0, tag);
+    total_bytes += sizeof(tmp);
     end_time = curr_clock_nsecs();
   } while (start_time + test_nsecs > end_time);
 
-  print_result("camellia-128 reference encryption",
+  print_result("camellia-128 SIMD256 GCM encryption",
 	       total_bytes, end_time - start_time);
 
   total_bytes = 0;
-  Camellia_set_key(test_vector_key_128, 128, &ctx_ref);
+  camellia_gcm_keysetup_simd128(&ctx_gcm, test_vector_key_128, 128 / 8);
+  memset(iv, 0, sizeof(iv));
 
   start_time = curr_clock_nsecs();
   do {
-    Camellia_decrypt_nblks(tmp, tmp, sizeof(tmp) / 16, &ctx_ref);
-    total_bytes += sizeof(tmp) - sizeof(tmp) % 16;
+    camellia_gcm_decrypt_simd256(&ctx_gcm, tmp, tmp, sizeof(tmp), iv, 12,
+				 NULL, 0, tag);
+    total_bytes += sizeof(tmp);
     end_time = curr_clock_nsecs();
   } while (start_time + test_nsecs > end_time);
 
-  print_result("camellia-128 reference decryption",
+  print_result("camellia-128 SIMD256 GCM decryption",
 	       total_bytes, end_time - start_time);
 
-  /* Test speed of 16-block SIMD128 implementation. */
+  total_bytes = 0;
+  camellia_gcm_siv_keysetup_simd128(&ctx_gcm_siv, test_vector_key_128,
+				    128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_gcm_siv_encrypt_simd256(&ctx_gcm_siv, tmp, tmp, sizeof(tmp), iv,
+				     NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 GCM-SIV encryption",
+	       total_bytes, end_time - start_time);
+
+  total_bytes = 0;
+  camellia_gcm_siv_keysetup_simd128(&ctx_gcm_siv, test_vector_key_128,
+				    128 / 8);
+  memset(iv, 0, sizeof(iv));
+
+  start_time = curr_clock_nsecs();
+  do {
+    camellia_gcm_siv_decrypt_simd256(&ctx_gcm_siv, tmp, tmp, sizeof(tmp), iv,
+				     NULL, 0, tag);
+    total_bytes += sizeof(tmp);
+    end_time = curr_clock_nsecs();
+  } while (start_time + test_nsecs > end_time);
+
+  print_result("camellia-128 SIMD256 GCM-SIV decryption",
+	       total_bytes, end_time - start_time);
+#endif
+
+#ifdef USE_SIMD512
+  /* Test speed of 64-block SIMD512 implementation. */
   total_bytes = 0;
   camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
 
   start_time = curr_clock_nsecs();
   do {
     for (j = 0; j < sizeof(tmp); ) {
-      camellia_encrypt_16blks_simd128(&ctx_simd, &tmp[j], &tmp[j]);
-      j += 16 * 16;
-      total_bytes += 16 * 16;
+      camellia_encrypt_64blks_simd512(&ctx_simd, &tmp[j], &tmp[j]);
+      j += 64 * 16;
+      total_bytes += 64 * 16;
     }
     end_time = curr_clock_nsecs();
   } while (start_time + test_nsecs > end_time);
 
-  print_result("camellia-128 SIMD128 (16 blocks) encryption",
+  print_result("camellia-128 SIMD512 (64 blocks) encryption",
 	       total_bytes, end_time - start_time);
 
   total_bytes = 0;
@@ -398,32 +3151,33 @@ static void do_speedtest(void)
   start_time = curr_clock_nsecs();
   do {
     for (j = 0; j < sizeof(tmp); ) {
-      camellia_decrypt_16blks_simd128(&ctx_simd, &tmp[j], &tmp[j]);
-      j += 16 * 16;
-      total_bytes += 16 * 16;
+      camellia_decrypt_64blks_simd512(&ctx_simd, &tmp[j], &tmp[j]);
+      j += 64 * 16;
+      total_bytes += 64 * 16;
     }
     end_time = curr_clock_nsecs();
   } while (start_time + test_nsecs > end_time);
 
-  print_result("camellia-128 SIMD128 (16 blocks) decryption",
+  print_result("camellia-128 SIMD512 (64 blocks) decryption",
 	       total_bytes, end_time - start_time);
+#endif
 
-#ifdef USE_SIMD256
-  /* Test speed of 32-block SIMD256 implementation. */
+#ifdef USE_SIMD256_EVEX
+  /* Test speed of 32-block register-resident EVEX implementation. */
   total_bytes = 0;
   camellia_keysetup_simd128(&ctx_simd, test_vector_key_128, 128 / 8);
 
   start_time = curr_clock_nsecs();
   do {
     for (j = 0; j < sizeof(tmp); ) {
-      camellia_encrypt_32blks_simd256(&ctx_simd, &tmp[j], &tmp[j]);
+      camellia_encrypt_32blks_simd256_evex(&ctx_simd, &tmp[j], &tmp[j]);
       j += 32 * 16;
       total_bytes += 32 * 16;
     }
     end_time = curr_clock_nsecs();
   } while (start_time + test_nsecs > end_time);
 
-  print_result("camellia-128 SIMD256 (32 blocks) encryption",
+  print_result("camellia-128 SIMD256 EVEX 32-blk encryption",
 	       total_bytes, end_time - start_time);
 
   total_bytes = 0;
@@ -432,14 +3186,14 @@ static void do_speedtest(void)
   start_time = curr_clock_nsecs();
   do {
     for (j = 0; j < sizeof(tmp); ) {
-      camellia_decrypt_32blks_simd256(&ctx_simd, &tmp[j], &tmp[j]);
+      camellia_decrypt_32blks_simd256_evex(&ctx_simd, &tmp[j], &tmp[j]);
       j += 32 * 16;
       total_bytes += 32 * 16;
     }
     end_time = curr_clock_nsecs();
   } while (start_time + test_nsecs > end_time);
 
-  print_result("camellia-128 SIMD256 (32 blocks) decryption",
+  print_result("camellia-128 SIMD256 EVEX 32-blk decryption",
 	       total_bytes, end_time - start_time);
 #endif
 }